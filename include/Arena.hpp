@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+// Bump allocator for per-request temporaries. Allocation is a pointer bump
+// inside the current chunk; nothing is freed individually. reset() releases
+// everything at once and keeps a single chunk large enough for the last
+// cycle, so steady-state keep-alive traffic does not touch malloc.
+class Arena {
+public:
+	// Constructor
+	explicit Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+	
+	// Destructor - frees all chunks
+	~Arena();
+	
+	// Allocate size bytes (aligned for any type)
+	void* allocate(size_t size);
+	
+	// Copy length bytes into the arena, NUL-terminated
+	char* copy(const char* data, size_t length);
+	
+	// Release every allocation (no object using the arena may outlive this)
+	void reset();
+	
+	// Stats
+	size_t used() const;
+	size_t capacity() const;
+
+private:
+	// Non-copyable
+	Arena(const Arena& other);
+	Arena& operator=(const Arena& rhs);
+	
+	// Start a chunk that fits at least size bytes
+	void grow(size_t size);
+	
+	// Members
+	std::vector<char*> _chunks;  // Last one is current
+	size_t _chunkSize;           // Minimum size of a new chunk
+	size_t _currentSize;         // Size of the current chunk
+	size_t _offset;              // Bytes used in the current chunk
+	size_t _used;                // Bytes handed out since the last reset()
+	size_t _capacity;            // Bytes held in all chunks
+	
+	// Constants
+	static const size_t DEFAULT_CHUNK_SIZE = 4096;
+	static const size_t MAX_RETAINED = 64 * 1024;  // Larger cycles are not kept across reset()
+	static const size_t ALIGNMENT = 16;
+};
+
+// STL allocator drawing from an Arena (deallocate is a no-op).
+// Without an arena it falls back to the heap, so containers using it work
+// the same whether or not their owner has an arena.
+template <typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	
+	template <typename U>
+	struct rebind {
+		typedef ArenaAllocator<U> other;
+	};
+	
+	ArenaAllocator(Arena* arena = NULL) : _arena(arena) {}
+	
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena()) {}
+	
+	pointer address(reference value) const { return &value; }
+	const_pointer address(const_reference value) const { return &value; }
+	
+	pointer allocate(size_type count, const void* = 0) {
+		if (_arena) {
+			return static_cast<pointer>(_arena->allocate(count * sizeof(T)));
+		}
+		return static_cast<pointer>(::operator new(count * sizeof(T)));
+	}
+	
+	void deallocate(pointer p, size_type) {
+		if (!_arena) {
+			::operator delete(p);
+		}
+	}
+	
+	size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+	
+	void construct(pointer p, const T& value) { new (static_cast<void*>(p)) T(value); }
+	void destroy(pointer p) { p->~T(); }
+	
+	Arena* arena() const { return _arena; }
+
+private:
+	Arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+	return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+	return lhs.arena() != rhs.arena();
+}
+
+// String whose buffer comes from an Arena
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > ArenaString;
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+
+// Destination for a request body that is consumed as it arrives instead of
+// being collected in HttpRequest's body string. Attached once the headers
+// are parsed; the parser hands it every body byte, in order.
+class BodySink {
+public:
+	virtual ~BodySink() {}
+	
+	// Next body bytes (failures are recorded by the sink and reported when
+	// the request is handled, so the rest of the body is still consumed)
+	virtual void write(const char* data, size_t size) = 0;
+};
+
+// Sink that drops the body, for a request answered without reading it
+class BodyDiscard : public BodySink {
+public:
+	void write(const char* data, size_t size) {
+		(void)data;
+		(void)size;
+	}
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <sys/types.h>
+#include "BodySink.hpp"
+
+// Request body kept in memory up to a limit and moved to an anonymous
+// temporary file once it grows past it, so large bodies cost disk instead
+// of RAM. The file is created with O_TMPFILE (never visible in the
+// directory; it disappears with its last fd), or mkstemp() where that is
+// unsupported. It can be given a name afterwards (an upload), and its fd
+// can serve as a CGI's stdin. Bytes still in the socket can be moved into
+// the file with splice(), never entering user space.
+class BodySpool : public BodySink {
+public:
+	// Constructor - directory holds the file (the upload directory if it is
+	// to be linked into place: same filesystem); memoryLimit 0 goes straight
+	// to the file
+	BodySpool(const std::string& directory, size_t memoryLimit);
+	
+	// Destructor - closes the file (removing it unless it was linked)
+	~BodySpool();
+	
+	// Next body bytes
+	void write(const char* data, size_t size);
+	
+	// Move up to max bytes from fd (a socket) into the file through a pipe.
+	// Returns the bytes taken from fd, 0 at end of input, -1 on error (errno
+	// EAGAIN: nothing to read); after -1 with canSplice() false, read and
+	// write() instead.
+	ssize_t splice(int fd, size_t max);
+	bool canSplice() const;
+	
+	// Body location
+	bool isFile() const;                  // In the file (else in getData())
+	int getFd() const;                    // File fd, -1 while in memory
+	const std::string& getData() const;   // Bytes kept in memory
+	size_t size() const;                  // Bytes received
+	bool hasFailed() const;               // The file could not be created or written
+	
+	// Give the file a name (must not exist yet); false on failure
+	bool linkTo(const std::string& path);
+
+private:
+	// Non-copyable
+	BodySpool(const BodySpool& other);
+	BodySpool& operator=(const BodySpool& rhs);
+	
+	// Create the file and move the memory bytes into it
+	bool spill();
+	
+	// Append to the file
+	bool writeFile(const char* data, size_t size);
+	
+	// Copy what a failed pipe-to-file splice() left in the pipe
+	void drainPipe(size_t size);
+	
+	// Members
+	std::string _directory;
+	size_t _memoryLimit;
+	std::string _data;      // Bytes while in memory
+	int _fd;
+	std::string _tempPath;  // Name of a mkstemp() file until it is linked or closed
+	size_t _size;
+	bool _failed;
+	int _pipe[2];           // splice() goes socket -> pipe -> file (created on first use)
+	bool _spliceable;       // Cleared when the socket or file does not support splice()
+	
+	// Bytes per splice() call: the default pipe capacity, so the pipe never fills
+	static const size_t SPLICE_CHUNK = 64 * 1024;
+};
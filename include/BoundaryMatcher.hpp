@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Substring search for a fixed pattern (a multipart delimiter), built once
+// and used for every piece of the body. Scans with memchr() for the first
+// pattern byte while that byte is rare in the data; once it turns up too
+// often (e.g. a payload full of '-' or CR bytes) the rest of the piece is
+// searched Boyer-Moore-Horspool style, skipping ahead by a precomputed
+// distance for the byte under the end of each window.
+class BoundaryMatcher {
+public:
+	// Constructor - precomputes the skip table (pattern must not be empty)
+	explicit BoundaryMatcher(const std::string& pattern);
+	
+	// Destructor
+	~BoundaryMatcher();
+	
+	// Offset of the first complete match in data, or size if none
+	size_t find(const char* data, size_t size) const;
+	
+	// Start of a pattern prefix running to the end of data (a match cut off
+	// by the end of the piece), or size if none
+	size_t findPrefix(const char* data, size_t size) const;
+	
+	// Pattern
+	const char* data() const;
+	size_t size() const;
+
+private:
+	// Non-copyable
+	BoundaryMatcher(const BoundaryMatcher& other);
+	BoundaryMatcher& operator=(const BoundaryMatcher& rhs);
+	
+	// Skip-table search from offset from
+	size_t findHorspool(const char* data, size_t size, size_t from) const;
+	
+	// Members
+	std::string _pattern;
+	size_t _skip[256];  // Shift for the byte under the window's last position
+	
+	// First-byte candidates that failed before switching to the skip table:
+	// a few, plus one per PREFILTER_BYTES_PER_MISS bytes scanned
+	static const size_t PREFILTER_MISSES = 4;
+	static const size_t PREFILTER_BYTES_PER_MISS = 64;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Pool of fixed-size I/O buffers carved out of larger slabs. Each event loop
+// owns one (no locking); clients borrow a buffer while they have bytes in
+// flight and hand it back as soon as it drains, so idle keep-alive
+// connections hold no buffer memory.
+class BufferPool {
+public:
+	// Constructor
+	BufferPool();
+	
+	// Destructor - frees all slabs (every buffer must have been released)
+	~BufferPool();
+	
+	// Borrow a BUFFER_SIZE buffer
+	char* acquire();
+	
+	// Give a buffer back
+	void release(char* buffer);
+	
+	// Stats
+	size_t inUse() const;
+	size_t capacity() const;  // Buffers held, in use or free
+	
+	// Constants
+	static const size_t BUFFER_SIZE = 16 * 1024;
+	static const size_t BUFFERS_PER_SLAB = 16;
+
+private:
+	// Non-copyable
+	BufferPool(const BufferPool& other);
+	BufferPool& operator=(const BufferPool& rhs);
+	
+	// Add a slab to the free list
+	void grow();
+	
+	// Free buffer (the link is stored in the buffer itself)
+	struct FreeBuffer {
+		FreeBuffer* next;
+	};
+	
+	// Members
+	std::vector<char*> _slabs;
+	FreeBuffer* _free;
+	size_t _inUse;
+};
@@ -54,7 +54,7 @@ struct CgiProcess {
 struct CgiStartResult {
 	bool success;
 	pid_t pid;
-	int stdinFd;   // Write to this to send data to CGI
+	int stdinFd;   // Write to this to send data to CGI (-1 if stdin is a file)
 	int stdoutFd;  // Read from this to get CGI output
 	std::string errorMessage;
 	int errorCode;
@@ -76,12 +76,15 @@ public:
 	// Destructor
 	~CgiHandler();
 	
-	// Start CGI script (non-blocking - returns immediately after fork)
+	// Start CGI script (non-blocking - returns immediately after fork).
+	// bodyFd: file holding the request body, read by the script as its stdin
+	// (-1: stdin is a pipe the caller writes the body to)
 	CgiStartResult startNonBlocking(const HttpRequest& request,
 	                                const RouteResult& route,
 	                                const std::string& clientIp,
 	                                int clientPort,
-	                                int serverPort);
+	                                int serverPort,
+	                                int bodyFd = -1);
 	
 	// Parse CGI output (headers + body) - made public for Server to use
 	bool parseCgiOutput(const std::string& output,
@@ -119,6 +122,10 @@ private:
 	                                          int clientPort,
 	                                          int serverPort) const;
 	
+	// HTTP_* variable for a header (name uppercase, dashes become underscores)
+	static std::string buildHeaderVariable(const char* name, size_t nameLength,
+	                                       const char* value, size_t valueLength);
+	
 	// Convert vector of strings to char** for execve
 	char** vectorToEnvp(const std::vector<std::string>& env) const;
 	
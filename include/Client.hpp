@@ -1,23 +1,80 @@
 #pragma once
 #include <string>
-#include <ctime>
+#include <deque>
+#include <algorithm>
 #include <sys/types.h>
 #include "ServerConfig.hpp"
 #include "HttpRequest.hpp"
+#include "TimerWheel.hpp"
+#include "BufferPool.hpp"
+
+class MultipartUpload;
+class BodySpool;
 
 // Client connection states
 enum ClientState {
-	STATE_READING_REQUEST,    // Reading HTTP request
-	STATE_PROCESSING,         // Processing request (CGI, file read, etc.)
-	STATE_WRITING_RESPONSE,   // Writing HTTP response
+	STATE_READING_REQUEST,    // Taking requests (earlier responses may still be sending)
+	STATE_PROCESSING,         // Next request waits for the connection's running CGI
+	STATE_WRITING_RESPONSE,   // No more requests: send what is queued, then close
 	STATE_DONE,               // Ready to close or keep-alive
 	STATE_ERROR               // Error occurred
 };
 
+// Timeout currently enforced by the client's timer
+enum ClientTimeout {
+	TIMEOUT_NONE,        // Not armed (waiting for a CGI - its own timer applies)
+	TIMEOUT_HEADER,      // client_header_timeout, runs from the first byte of the request
+	TIMEOUT_BODY,        // client_body_timeout, re-armed on every read
+	TIMEOUT_KEEPALIVE,   // keepalive_timeout, idle between requests
+	TIMEOUT_SEND         // send_timeout, re-armed on every write
+};
+
+// Queued output: bytes in memory, a range of an open file sent with sendfile(),
+// or the reserved place of a response that is still being produced
+struct OutputSegment {
+	char* buffer;         // Pooled memory bytes (NULL: the bytes are in data)
+	size_t length;        // Bytes used in buffer
+	std::string data;     // Memory bytes too large for a pooled buffer
+	size_t dataOffset;    // How much of the memory bytes has been sent
+	int fd;               // File to send from (-1 for memory segments)
+	off_t fileOffset;     // Next file offset to send
+	off_t fileRemaining;  // File bytes not yet written
+	bool ownsFd;          // Close fd once the segment is done
+	bool reserved;        // Place held for a later response (nothing after it is sent)
+	
+	OutputSegment()
+		: buffer(NULL),
+		  length(0),
+		  data(""),
+		  dataOffset(0),
+		  fd(-1),
+		  fileOffset(0),
+		  fileRemaining(0),
+		  ownsFd(false),
+		  reserved(false) {}
+	
+	// Memory bytes, wherever they are stored
+	const char* bytes() const { return buffer ? buffer : data.data(); }
+	size_t size() const { return buffer ? length : data.size(); }
+	
+	// Exchange contents without copying the bytes
+	void swap(OutputSegment& other) {
+		std::swap(buffer, other.buffer);
+		std::swap(length, other.length);
+		data.swap(other.data);
+		std::swap(dataOffset, other.dataOffset);
+		std::swap(fd, other.fd);
+		std::swap(fileOffset, other.fileOffset);
+		std::swap(fileRemaining, other.fileRemaining);
+		std::swap(ownsFd, other.ownsFd);
+		std::swap(reserved, other.reserved);
+	}
+};
+
 class Client {
 public:
-	// Constructor
-	Client(int fd, const std::string& address, int port);
+	// Constructor - I/O buffers are borrowed from pool while in use
+	Client(int fd, const std::string& address, int port, BufferPool& pool);
 	
 	// Destructor
 	~Client();
@@ -26,28 +83,54 @@ public:
 	ssize_t readData();      // Read from socket into buffer
 	ssize_t writeData();     // Write from buffer to socket
 	
+	// Body bytes can go from the socket straight into the spool file: the
+	// body has a Content-Length, is spooled to a file, and all buffered
+	// input is parsed. spliceBody() then replaces readData() (same results).
+	bool canSpliceBody() const;
+	ssize_t spliceBody();
+	
+	// Socket readiness, set from epoll events and cleared when the socket
+	// would block (writes are tried until then; edge-triggered mode also
+	// keeps read readiness across wakeups)
+	void setReadReady(bool ready);
+	void setWriteReady(bool ready);
+	bool isReadReady() const;
+	bool isWriteReady() const;
+	
+	// On the server's list of clients with I/O left over (edge-triggered mode)
+	void setReadyListed(bool listed);
+	bool isReadyListed() const;
+	
 	// Buffer management
-	void appendToReadBuffer(const char* data, size_t len);
 	void appendToWriteBuffer(const char* data, size_t len);
 	void appendToWriteBuffer(const std::string& data);
+	void appendSegment(std::string& data);  // Takes the bytes (data is left empty)
+	void consumeReadBuffer(size_t len);     // Drop parsed bytes from the front
 	void clearReadBuffer();
 	void clearWriteBuffer();
 	
+	// Queue a file range after the pending output (ownsFd: close fd when sent)
+	void appendFileSegment(int fd, off_t offset, off_t length, bool ownsFd);
+	
+	// Pipelined responses go out in request order. A response produced later
+	// (CGI) reserves its place; output queued after it waits until it is filled.
+	void reserveOutput();
+	void beginReservedOutput();  // Queue into the reserved place (later output is set aside)
+	void endReservedOutput();    // Put the set-aside output back behind it
+	
 	// Getters
 	int getFd() const;
 	ClientState getState() const;
 	const std::string& getAddress() const;
 	int getPort() const;
-	const std::string& getReadBuffer() const;
-	const std::string& getWriteBuffer() const;
-	size_t getReadBufferSize() const;
+	const char* getReadData() const;        // Unconsumed input
+	size_t getReadBufferSize() const;       // Unconsumed input size
 	size_t getWriteBufferSize() const;
-	time_t getLastActivity() const;
-	bool hasDataToWrite() const;
+	bool hasDataToWrite() const;            // Output ready to send (stops at a reserved place)
+	bool hasPendingOutput() const;          // Anything queued, including a reserved place
 	
 	// Setters
 	void setState(ClientState state);
-	void updateLastActivity();
 	
 	// Server config association
 	void setServerConfig(const ServerConfig* config);
@@ -57,8 +140,21 @@ public:
 	HttpRequest& getRequest();
 	const HttpRequest& getRequest() const;
 	
-	// Timeout check
-	bool isTimedOut(time_t timeout) const;
+	// Allocator for the current request's temporaries (reset with the request)
+	Arena& getArena();
+	
+	// Upload saved while the current request's body arrives (owned, dropped by reset())
+	void setUpload(MultipartUpload* upload);
+	MultipartUpload* getUpload();
+	
+	// Temporary file holding the current request's body (owned, dropped by reset())
+	void setSpool(BodySpool* spool);
+	BodySpool* getSpool();
+	
+	// Inactivity timer, armed by the server in its timer wheel
+	TimerNode& getTimer();
+	ClientTimeout getTimeoutPhase() const;
+	void setTimeoutPhase(ClientTimeout phase);
 	
 	// Keep-alive
 	void setKeepAlive(bool keepAlive);
@@ -68,7 +164,8 @@ public:
 	void incrementRequestCount();
 	int getRequestCount() const;
 	
-	// Reset for keep-alive (new request on same connection)
+	// Reset for the next request on the connection (pending input and output
+	// are kept). Resets the arena: nothing allocated from it may still be alive.
 	void reset();
 
 private:
@@ -85,23 +182,52 @@ private:
 	ClientState _state;
 	
 	// Buffers
-	std::string _readBuffer;
-	std::string _writeBuffer;
-	size_t _writeOffset;  // How much of write buffer has been sent
+	BufferPool& _pool;
+	char* _input;                       // Pooled read buffer (NULL while no input is pending)
+	size_t _inputStart;                 // Start of unconsumed input in _input
+	size_t _inputEnd;                   // End of received input in _input
+	std::deque<OutputSegment> _output;  // Pending response bytes, in order
+	size_t _outputSize;                 // Bytes queued in _output and not yet sent
+	std::deque<OutputSegment> _heldOutput;  // Output after the reserved place while it is filled
+	
+	// File segment fallback when sendfile() is unsupported
+	bool _fileWindowMode;      // Stream file segments through _fileWindow
+	off_t _fileWindowOffset;   // Next file offset to read into the window
+	std::string _fileWindow;   // Read-ahead window, refilled as the socket drains
+	size_t _fileWindowSent;    // How much of the window has been sent
+	
+	// Readiness
+	bool _readReady;
+	bool _writeReady;
+	bool _readyListed;
 	
 	// Timing
-	time_t _lastActivity;
+	TimerNode _timer;
+	ClientTimeout _timeoutPhase;
 	
 	// Associated server config (set after Host header is parsed)
 	const ServerConfig* _serverConfig;
 	
+	// Per-request temporaries, released by reset() (declared before _request)
+	Arena _arena;
+	
 	// HTTP request parser
 	HttpRequest _request;
+	MultipartUpload* _upload;   // Sink of _request's body, if streamed to disk
+	BodySpool* _spool;          // Sink of _request's body, if spooled
 	
 	// Keep-alive
 	bool _keepAlive;
 	int _requestCount;
 	
+	// Write helpers
+	ssize_t writeMemory();
+	ssize_t writeFile(OutputSegment& segment);
+	ssize_t writeFileWindow(OutputSegment& segment);
+	void popSegment();
+	
 	// Buffer limits
-	static const size_t MAX_READ_BUFFER = 1024 * 1024;  // 1MB default (overridden by client_max_body_size)
+	static const size_t SENDFILE_CHUNK = 1024 * 1024;   // Max bytes per sendfile() call
+	static const size_t FILE_WINDOW_SIZE = 64 * 1024;   // Read-ahead window when sendfile() is unavailable
+	static const int MAX_IOV = 64;                      // Memory segments gathered per writev() call
 };
\ No newline at end of file
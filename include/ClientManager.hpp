@@ -1,19 +1,21 @@
 #pragma once
-#include <map>
 #include <vector>
 #include "Client.hpp"
 #include "Epoll.hpp"
+#include "FdTable.hpp"
+#include "BufferPool.hpp"
 
 class ClientManager {
 public:
-	// Constructor
-	ClientManager(Epoll& epoll);
+	// Constructor - clients borrow their I/O buffers from buffers
+	ClientManager(Epoll& epoll, FdTable& fds, BufferPool& buffers);
 	
 	// Destructor
 	~ClientManager();
 	
-	// Client lifecycle
-	Client* addClient(int fd, const std::string& address, int port);
+	// Client lifecycle (the client's slot in the fd table is returned by addClient,
+	// which registers fd in epoll for events)
+	FdSlot* addClient(int fd, const std::string& address, int port, uint32_t events);
 	void removeClient(int fd);
 	Client* getClient(int fd);
 	
@@ -23,10 +25,6 @@ public:
 	// Get all client fds (for iteration)
 	std::vector<int> getAllClientFds() const;
 	
-	// Timeout management
-	void checkTimeouts(time_t timeout);
-	std::vector<int> getTimedOutClients(time_t timeout) const;
-	
 	// Stats
 	size_t getClientCount() const;
 
@@ -37,5 +35,7 @@ private:
 	
 	// Members
 	Epoll& _epoll;
-	std::map<int, Client*> _clients;
+	FdTable& _fds;        // Clients live in the FD_CLIENT slots
+	BufferPool& _buffers;
+	size_t _clientCount;
 };
\ No newline at end of file
@@ -9,12 +9,13 @@ enum EventType {
 	EVENT_WRITE  = EPOLLOUT,
 	EVENT_ERROR  = EPOLLERR,
 	EVENT_HANGUP = EPOLLHUP,
-	EVENT_RDHUP  = EPOLLRDHUP  // Peer closed connection
+	EVENT_RDHUP  = EPOLLRDHUP,  // Peer closed connection
+	EVENT_EDGE   = EPOLLET      // Report readiness changes only (edge-triggered)
 };
 
 // Event structure returned by wait()
 struct Event {
-	int fd;
+	void* data;         // Pointer registered with add()/modify()
 	uint32_t events;
 	
 	bool isReadable() const  { return events & EVENT_READ; }
@@ -32,11 +33,12 @@ public:
 	// Destructor - closes epoll fd
 	~Epoll();
 	
-	// Add fd to epoll
-	void add(int fd, uint32_t events);
+	// Add fd to epoll; data is handed back with each of its events
+	void add(int fd, uint32_t events, void* data);
 	
-	// Modify events for fd
-	void modify(int fd, uint32_t events);
+	// Modify events for fd (data replaces the registered pointer); no syscall
+	// when they match what is already registered
+	void modify(int fd, uint32_t events, void* data);
 	
 	// Remove fd from epoll
 	void remove(int fd);
@@ -52,8 +54,20 @@ private:
 	Epoll(const Epoll& other);
 	Epoll& operator=(const Epoll& rhs);
 	
+	// Registered events and pointer of an fd
+	struct Interest {
+		uint32_t events;
+		void* data;
+		
+		Interest() : events(0), data(NULL) {}
+	};
+	
+	// Remember what fd is registered with
+	void setInterest(int fd, uint32_t events, void* data);
+	
 	// Members
 	int _epollFd;
+	std::vector<Interest> _interest;  // Indexed by fd
 	static const int MAX_EVENTS = 1024;
 	struct epoll_event _eventBuffer[MAX_EVENTS];
 };
@@ -0,0 +1,67 @@
+#pragma once
+#include <deque>
+#include <cstddef>
+
+class Socket;
+class Client;
+struct CgiSession;
+
+// What a watched descriptor is
+enum FdKind {
+	FD_FREE,        // Not watched
+	FD_LISTEN,      // Listen socket
+	FD_CLIENT,      // Client connection
+	FD_CGI_STDOUT,  // CGI output pipe (read end)
+	FD_CGI_STDIN,   // CGI input pipe (write end)
+	FD_HANDOFF      // Worker thread handoff pipe (read end)
+};
+
+// Per-descriptor handler; its address is stored in epoll_event.data.ptr
+struct FdSlot {
+	int fd;
+	FdKind kind;
+	Socket* socket;     // FD_LISTEN
+	Client* client;     // FD_CLIENT
+	CgiSession* cgi;    // FD_CGI_*, or the CGI session running for an FD_CLIENT
+	int listenPort;     // FD_CLIENT: port the connection arrived on
+	
+	FdSlot()
+		: fd(-1),
+		  kind(FD_FREE),
+		  socket(NULL),
+		  client(NULL),
+		  cgi(NULL),
+		  listenPort(0) {}
+};
+
+// Dense table of slots indexed by fd. Backed by a deque so slots never move
+// while the table grows - epoll keeps pointers to them.
+class FdTable {
+public:
+	// Constructor
+	FdTable();
+	
+	// Destructor
+	~FdTable();
+	
+	// Claim the slot of fd (reset to kind), growing the table if needed
+	FdSlot* acquire(int fd, FdKind kind);
+	
+	// Slot of fd, or NULL if it is not in use
+	FdSlot* find(int fd);
+	const FdSlot* find(int fd) const;
+	
+	// Free the slot of fd
+	void release(int fd);
+	
+	// Number of slots (highest fd seen + 1), for iteration with find()
+	size_t size() const;
+
+private:
+	// Non-copyable
+	FdTable(const FdTable& other);
+	FdTable& operator=(const FdTable& rhs);
+	
+	// Members
+	std::deque<FdSlot> _slots;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <map>
+#include <list>
+#include <ctime>
+#include <sys/types.h>
+#include "OpenFileCache.hpp"
+
+// Byte-bounded LRU of fully prebuilt responses for small static files.
+// Entries are keyed by resolved request path and validated against the
+// file they were built from.
+class FileCache {
+public:
+	// Constructor
+	FileCache(size_t maxBytes, size_t maxEntrySize, time_t validSeconds);
+	
+	// Destructor
+	~FileCache();
+	
+	// Find prebuilt response; revalidated with stat() once older than the valid interval.
+	// Returns NULL on miss or if the file changed on disk.
+	const std::string* find(const std::string& key);
+	
+	// Insert response built from filePath (response is swapped in, left empty).
+	// Returns NULL if the response does not fit.
+	const std::string* insert(const std::string& key, const std::string& filePath,
+	                          const OpenFileInfo& info, std::string& response);
+	
+	// Drop every entry built from filePath (e.g. after DELETE)
+	void remove(const std::string& filePath);
+	
+	// Largest file body accepted
+	size_t getMaxEntrySize() const;
+	
+	// Budget for all responses, headers included
+	size_t getMaxBytes() const;
+	
+	// Stats
+	size_t size() const;
+	size_t bytes() const;
+
+private:
+	// Non-copyable
+	FileCache(const FileCache& other);
+	FileCache& operator=(const FileCache& rhs);
+	
+	struct Entry {
+		std::string response;                    // Status line + headers + body
+		std::string filePath;                    // File the body was read from
+		off_t size;
+		time_t mtime;
+		ino_t inode;
+		time_t validated;                        // Last time the entry was checked against disk
+		std::list<std::string>::iterator lruPos; // Position in _lru
+	};
+	
+	typedef std::map<std::string, Entry> EntryMap;
+	
+	// Erase entry and release its bytes
+	void erase(EntryMap::iterator it);
+	
+	// Members
+	EntryMap _entries;
+	std::list<std::string> _lru;  // Most recently used first
+	size_t _bytes;
+	size_t _maxBytes;
+	size_t _maxEntrySize;
+	time_t _validSeconds;
+};
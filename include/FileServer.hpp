@@ -2,10 +2,16 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "ServerConfig.hpp"
 #include "LocationConfig.hpp"
 #include "HttpRequest.hpp"
 #include "Router.hpp"
+#include "OpenFileCache.hpp"
+#include "FileCache.hpp"
+#include "Response.hpp"
+#include "Mutex.hpp"
 
 // File serving result
 struct FileResult {
@@ -17,6 +23,12 @@ struct FileResult {
 	std::string errorMessage;
 	bool isDirectory;
 	std::string redirectPath;  // For directory without trailing slash
+	int fileFd;                // Open file to stream instead of body (-1 if none)
+	off_t fileSize;            // Bytes to stream from fileFd
+	std::string cachedResponse;  // Prebuilt response copied from the file cache (empty if none)
+	std::string etag;          // Validators of the served file (empty if none)
+	std::string lastModified;
+	std::vector<ByteRange> ranges;  // Requested ranges of fileFd (206), empty for the whole file
 	
 	FileResult()
 		: success(false),
@@ -26,9 +38,17 @@ struct FileResult {
 		  body(""),
 		  errorMessage(""),
 		  isDirectory(false),
-		  redirectPath("") {}
+		  redirectPath(""),
+		  fileFd(-1),
+		  fileSize(0),
+		  cachedResponse(""),
+		  etag(""),
+		  lastModified(""),
+		  ranges() {}
 };
 
+// Static file server. One instance is shared by all event loop threads:
+// the caches are guarded by a mutex and hits are copied out (cached fds are dup'ed).
 class FileServer {
 public:
 	// Constructor
@@ -64,6 +84,12 @@ public:
 	// Get file modification time (for caching headers)
 	std::string getLastModified(const std::string& path) const;
 	
+	// Format time as HTTP-date
+	static std::string formatHttpDate(time_t time);
+	
+	// Parse HTTP-date (any of the three RFC 7231 formats)
+	static bool parseHttpDate(const std::string& value, time_t& time);
+	
 	// Delete file
 	FileResult deleteFile(const HttpRequest& request, const RouteResult& route);
 
@@ -78,9 +104,56 @@ private:
 	// Read file content
 	bool readFile(const std::string& path, std::string& content) const;
 	
+	// Collect file metadata and validators from stat() data
+	void describeFile(const std::string& path, const struct stat& st, OpenFileInfo& info) const;
+	
+	// Open file for streaming and collect its metadata (caller owns info.fd)
+	bool openFile(const std::string& path, OpenFileInfo& info) const;
+	
+	// Evaluate If-None-Match / If-Modified-Since against the file validators
+	bool isNotModified(const HttpRequest& request, const OpenFileInfo& info) const;
+	
+	// Build a 304 result carrying the validators
+	FileResult notModified(const OpenFileInfo& info) const;
+	
+	// Open file cache of a server block (NULL if disabled)
+	OpenFileCache* getOpenFileCache(const ServerConfig* server);
+	
+	// In-memory response cache of a server block (NULL if disabled)
+	FileCache* getFileCache(const ServerConfig* server);
+	
+	// Whether a request may be answered from the file cache
+	bool isCacheableRequest(const HttpRequest& request) const;
+	
+	// Copy a cached entry out under the lock; info.fd is a dup owned by the caller
+	bool lookupOpenFile(OpenFileCache* cache, const std::string& path, OpenFileInfo& info);
+	
+	// Store a dup of info.fd in the open file cache (caller keeps info.fd)
+	void storeOpenFile(OpenFileCache* cache, const std::string& path, const OpenFileInfo& info);
+	
+	// Copy a prebuilt response out of the file cache
+	bool lookupResponse(FileCache* fileCache, const std::string& key, std::string& response);
+	
+	// Read a small file and build its complete response into response, storing it
+	// in the file cache if the cache takes it; false only if the file cannot be read
+	bool cacheResponse(FileCache* fileCache, const std::string& key,
+	                   const std::string& filePath, const OpenFileInfo& info,
+	                   std::string& response);
+	
+	// Build a successful result for an open file (takes ownership of info.fd,
+	// answers from memory when the file fits the file cache)
+	FileResult serveOpenFile(const HttpRequest& request, const OpenFileInfo& info,
+	                         FileCache* fileCache, const std::string& key,
+	                         const std::string& filePath);
+	
+	// Resolve Range / If-Range against the file: 200 (whole file), 206 or 416
+	int evaluateRange(const HttpRequest& request, const OpenFileInfo& info,
+	                  std::vector<ByteRange>& ranges) const;
+	
 	// Try to find index file in directory
 	std::string findIndexFile(const std::string& dirPath, 
-	                          const std::vector<std::string>& indexFiles) const;
+	                          const std::vector<std::string>& indexFiles,
+	                          OpenFileCache* cache);
 	
 	// HTML escape for directory listing
 	std::string htmlEscape(const std::string& str) const;
@@ -100,6 +173,19 @@ private:
 	// MIME types map
 	std::map<std::string, std::string> _mimeTypes;
 	
-	// Maximum file size to serve (to prevent memory issues)
+	// Open file caches, one per server block with open_file_cache enabled
+	std::map<const ServerConfig*, OpenFileCache*> _openFileCaches;
+	
+	// Prebuilt response caches, one per server block with file_cache_size set
+	std::map<const ServerConfig*, FileCache*> _fileCaches;
+	
+	// Guards both cache maps and every cache in them
+	Mutex _cacheMutex;
+	
+	// Maximum file size read into memory (error pages); static files
+	// are streamed from disk and have no size limit
 	static const size_t MAX_FILE_SIZE = 100 * 1024 * 1024;  // 100MB
+	
+	// Range specs accepted per request (more are answered with the whole file)
+	static const size_t MAX_RANGES = 64;
 };
\ No newline at end of file
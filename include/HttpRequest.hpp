@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
-#include <map>
+#include "Arena.hpp"
+#include "BodySink.hpp"
 #include <vector>
 #include <sys/types.h>
 
@@ -11,31 +12,89 @@ enum HttpParseState {
 	PARSE_BODY,
 	PARSE_CHUNKED_SIZE,
 	PARSE_CHUNKED_DATA,
+	PARSE_CHUNKED_DATA_END,   // CRLF closing a chunk's data
 	PARSE_CHUNKED_TRAILER,
 	PARSE_COMPLETE,
 	PARSE_ERROR
 };
 
+// Common request headers, interned into fixed slots (see HEADER_NAMES)
+enum HttpHeader {
+	HEADER_ACCEPT,
+	HEADER_ACCEPT_CHARSET,
+	HEADER_ACCEPT_ENCODING,
+	HEADER_ACCEPT_LANGUAGE,
+	HEADER_AUTHORIZATION,
+	HEADER_CACHE_CONTROL,
+	HEADER_CONNECTION,
+	HEADER_CONTENT_DISPOSITION,
+	HEADER_CONTENT_ENCODING,
+	HEADER_CONTENT_LENGTH,
+	HEADER_CONTENT_TYPE,
+	HEADER_COOKIE,
+	HEADER_DNT,
+	HEADER_EXPECT,
+	HEADER_FORWARDED,
+	HEADER_HOST,
+	HEADER_IF_MATCH,
+	HEADER_IF_MODIFIED_SINCE,
+	HEADER_IF_NONE_MATCH,
+	HEADER_IF_RANGE,
+	HEADER_IF_UNMODIFIED_SINCE,
+	HEADER_KEEP_ALIVE,
+	HEADER_ORIGIN,
+	HEADER_PRAGMA,
+	HEADER_PRIORITY,
+	HEADER_RANGE,
+	HEADER_REFERER,
+	HEADER_SEC_FETCH_DEST,
+	HEADER_SEC_FETCH_MODE,
+	HEADER_SEC_FETCH_SITE,
+	HEADER_SEC_FETCH_USER,
+	HEADER_TE,
+	HEADER_TRANSFER_ENCODING,
+	HEADER_UPGRADE,
+	HEADER_UPGRADE_INSECURE_REQUESTS,
+	HEADER_USER_AGENT,
+	HEADER_X_FILENAME,
+	HEADER_X_FORWARDED_FOR,
+	HEADER_X_REQUESTED_WITH,
+	HEADER_COUNT,
+	HEADER_UNKNOWN = HEADER_COUNT
+};
+
+// Header outside the known set; name (lowercase) and value live in the
+// request's arena and are NUL-terminated
+struct HeaderField {
+	const char* name;
+	size_t nameLength;
+	const char* value;
+	size_t valueLength;
+};
+
 // HTTP parsing result
 enum HttpParseResult {
 	PARSE_INCOMPLETE,    // Need more data
+	PARSE_HEADERS_DONE,  // Headers parsed, a body follows (call again to read it)
 	PARSE_SUCCESS,       // Request fully parsed
 	PARSE_FAILED         // Parse error
 };
 
 class HttpRequest {
 public:
-	// Constructor
-	HttpRequest();
+	// Constructor - unknown headers are stored in arena
+	explicit HttpRequest(Arena& arena);
 	
 	// Destructor
 	~HttpRequest();
 	
-	// Main parsing method - call repeatedly as data arrives
+	// Main parsing method - call repeatedly as data arrives, passing the
+	// unconsumed input (it must start where the previous call stopped)
 	// Returns PARSE_INCOMPLETE if more data needed
+	// Returns PARSE_HEADERS_DONE once, when the headers of a request with a body are parsed
 	// Returns PARSE_SUCCESS when request is complete
 	// Returns PARSE_FAILED on error
-	HttpParseResult parse(const std::string& data, size_t& bytesConsumed);
+	HttpParseResult parse(const char* data, size_t size, size_t& bytesConsumed);
 	
 	// Reset for new request (keep-alive)
 	void reset();
@@ -47,26 +106,50 @@ public:
 	const std::string& getQueryString() const;   // Query string (after ?)
 	const std::string& getHttpVersion() const;
 	
-	// Getters - Headers (case-insensitive lookup)
+	// Getters - Known headers (direct slot access, empty if absent)
+	const std::string& getHeader(HttpHeader header) const;
+	bool hasHeader(HttpHeader header) const;
+	
+	// Getters - Any header by name (case-insensitive lookup)
 	std::string getHeader(const std::string& name) const;
-	const std::map<std::string, std::string>& getHeaders() const;
 	bool hasHeader(const std::string& name) const;
 	
+	// Getters - Headers outside the known set, names lowercase
+	typedef std::vector<HeaderField> HeaderList;
+	const HeaderList& getOtherHeaders() const;
+	
+	// Lowercase name of a known header, and the reverse (case-insensitive)
+	static const char* headerName(HttpHeader header);
+	static HttpHeader findHeader(const char* name, size_t length);
+	
 	// Getters - Body
-	const std::string& getBody() const;
+	const std::string& getBody() const;     // Empty if the body went to a sink
 	size_t getContentLength() const;
+	size_t getBodySize() const;             // Body bytes received so far
 	bool isChunked() const;
 	
+	// Send the body to sink instead of getBody() (not owned; attach it when
+	// parse() returns PARSE_HEADERS_DONE, cleared by reset())
+	void setBodySink(BodySink* sink);
+	BodySink* getBodySink() const;
+	
+	// Count Content-Length body bytes the caller moved into the sink itself
+	// (spliced past the parser); completes the request once all are in
+	void addSplicedBody(size_t size);
+	
 	// Getters - State
 	HttpParseState getState() const;
 	const std::string& getErrorMessage() const;
+	int getErrorStatus() const;     // Response status for a failed parse (400, 413)
 	
 	// Getters - Derived info
 	std::string getHost() const;
 	int getPort() const;            // From Host header, or 80 by default
 	bool isKeepAlive() const;       // Based on Connection header and HTTP version
 	
-	// Set max body size (for validation)
+	// Set max body size (for validation); a chunked body fails with 413 before
+	// a chunk that would exceed it reaches the body or sink. Reset restores
+	// the default.
 	void setMaxBodySize(size_t maxSize);
 
 private:
@@ -75,10 +158,13 @@ private:
 	HttpRequest& operator=(const HttpRequest& rhs);
 	
 	// Parsing helpers
-	bool parseRequestLine(const std::string& line);
-	bool parseHeader(const std::string& line);
-	bool parseChunkedSize(const std::string& line);
+	bool findLineEnd(const char* data, size_t size, size_t pos, size_t& lineEnd);
+	bool parseRequestLine(const char* line, size_t length);
+	bool parseHeader(const char* line, size_t length);
+	bool parseChunkedSize(const char* line, size_t length);
+	void appendBody(const char* data, size_t size);
 	void parseUri();
+	const HeaderField* findOtherHeader(const char* name, size_t length) const;
 	
 	// Case-insensitive string comparison
 	static std::string toLower(const std::string& str);
@@ -90,11 +176,17 @@ private:
 	std::string _queryString;
 	std::string _httpVersion;
 	
-	// Headers (stored lowercase for case-insensitive lookup)
-	std::map<std::string, std::string> _headers;
+	// Headers: known ones in fixed slots, the rest in a list (names lowercase)
+	std::string _knownHeaders[HEADER_COUNT];
+	bool _hasKnownHeader[HEADER_COUNT];
+	HeaderList _otherHeaders;     // Capacity kept across requests
+	Arena& _arena;                // Owned by the client, reset with this request
+	size_t _headerCount;
 	
 	// Body
 	std::string _body;
+	BodySink* _bodySink;
+	size_t _bodySize;
 	size_t _contentLength;
 	bool _chunked;
 	size_t _currentChunkSize;
@@ -102,10 +194,13 @@ private:
 	
 	// State
 	HttpParseState _state;
+	size_t _scanOffset;  // Bytes of the pending line already scanned for CRLF
 	std::string _errorMessage;
+	int _errorStatus;
 	
 	// Limits
 	size_t _maxBodySize;
+	static const size_t DEFAULT_MAX_BODY_SIZE = 1024 * 1024 * 1024;  // 1 GB
 	static const size_t MAX_REQUEST_LINE = 8192;
 	static const size_t MAX_HEADER_SIZE = 8192;
 	static const size_t MAX_HEADERS_COUNT = 100;
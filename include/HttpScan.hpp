@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+// Byte scanning for the request parser. Each routine has an SSE2 and an AVX2
+// version (16 / 32 bytes per step) and a scalar fallback; the best one the CPU
+// supports is picked once at startup.
+class HttpScan {
+public:
+	// First '\n' in [begin, end), or NULL
+	static const char* findNewline(const char* begin, const char* end);
+
+	// Length of the leading run of token characters (RFC 7230 tchar),
+	// e.g. the header name before its ':'
+	static size_t tokenLength(const char* data, size_t size);
+
+	// Lowercase ASCII letters in place
+	static void toLower(char* data, size_t size);
+
+	// Selected implementation ("avx2", "sse2" or "scalar")
+	static const char* implementation();
+
+private:
+	// Not instantiable
+	HttpScan();
+	HttpScan(const HttpScan& other);
+	HttpScan& operator=(const HttpScan& rhs);
+};
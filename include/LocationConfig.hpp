@@ -21,6 +21,7 @@ public:
 	void addCgiPass(const std::string& path);
 	void addCgiExtension(const std::string& ext);
 	void setClientMaxBodySize(size_t size);
+	void setClientBodyBufferSize(size_t size);
 	void setUploadStore(const std::string& store);
 	
 	// Getters
@@ -34,6 +35,7 @@ public:
 	const std::vector<std::string>& getCgiPass() const;
 	const std::vector<std::string>& getCgiExtension() const;
 	size_t getClientMaxBodySize() const;
+	size_t getClientBodyBufferSize() const;
 	const std::string& getUploadStore() const;
 	
 	// Presence checks (for inheritance resolution)
@@ -41,6 +43,7 @@ public:
 	bool hasIndex() const;
 	bool hasAutoIndex() const;
 	bool hasClientMaxBodySize() const;
+	bool hasClientBodyBufferSize() const;
 	
 	// Inheritance resolution (called by parser after parsing)
 	void inheritFrom(const LocationConfig& parent);
@@ -54,6 +57,7 @@ private:
 	std::vector<std::string> _index;
 	bool _autoindex;
 	size_t _client_max_body_size;
+	size_t _client_body_buffer_size;   // Larger bodies are spooled to a temporary file
 	
 	// Location-only directives
 	std::vector<std::string> _allowed_methods;
@@ -67,6 +71,7 @@ private:
 	bool _root_set;
 	bool _autoindex_set;
 	bool _client_max_body_size_set;
+	bool _client_body_buffer_size_set;
 	bool _return_set;
 	bool _upload_store_set;
 	
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+
+// How the accepting thread spreads connections over worker threads
+enum BalanceMode {
+	BALANCE_ROUND_ROBIN,  // Next thread in turn
+	BALANCE_LEAST_CONN    // Thread with the fewest open connections
+};
+
+// Directives of the main (top-level) context
+class MainConfig {
+public:
+	// Orthodox Canonical Form
+	MainConfig();
+	MainConfig(const MainConfig& other);
+	MainConfig& operator=(const MainConfig& rhs);
+	~MainConfig();
+	
+	// Setters (used by parser)
+	void setWorkerProcesses(int count);
+	void setWorkerThreads(int count);
+	void setWorkerBalance(BalanceMode mode);
+	void setEdgeTriggered(bool enabled);
+	
+	// Getters
+	int getWorkerProcesses() const;
+	int getWorkerThreads() const;
+	BalanceMode getWorkerBalance() const;
+	bool getEdgeTriggered() const;
+	
+	// Presence checks
+	bool hasWorkerProcesses() const;
+	bool hasWorkerThreads() const;
+	bool hasWorkerBalance() const;
+	bool hasEdgeTriggered() const;
+	
+	// Limits
+	static const int MAX_WORKER_PROCESSES = 1024;
+	static const int MAX_WORKER_THREADS = 256;
+
+private:
+	int _worker_processes;
+	int _worker_threads;
+	BalanceMode _worker_balance;
+	bool _edge_triggered;
+	
+	bool _worker_processes_set;
+	bool _worker_threads_set;
+	bool _worker_balance_set;
+	bool _edge_triggered_set;
+};
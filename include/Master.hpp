@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <ctime>
+#include <csignal>
+#include <sys/types.h>
+#include "ServerConfig.hpp"
+#include "MainConfig.hpp"
+
+// Master process: forks worker_processes workers and supervises them.
+// Each worker runs its own Server (own Epoll, own SO_REUSEPORT listen sockets).
+class Master {
+public:
+	// Constructor
+	Master(const std::vector<ServerConfig>& servers, const MainConfig& main);
+	
+	// Destructor
+	~Master();
+	
+	// Fork the workers and supervise them until stopped (returns exit status)
+	int run();
+	
+	// Request shutdown (async-signal-safe)
+	void stop();
+
+private:
+	// Non-copyable
+	Master(const Master& other);
+	Master& operator=(const Master& rhs);
+	
+	struct Worker {
+		pid_t pid;
+		time_t started;
+		
+		Worker() : pid(-1), started(0) {}
+	};
+	
+	// Setup
+	void installSignalHandlers();
+	void checkListenAddresses() const;
+	
+	// Worker management
+	bool spawnWorker(size_t slot);
+	void runWorker(size_t slot);  // Child side - never returns
+	void handleWorkerExit(pid_t pid, int status);
+	void stopWorkers();
+	
+	// Members
+	std::vector<ServerConfig> _servers;
+	MainConfig _main;
+	std::vector<Worker> _workers;
+	volatile sig_atomic_t _running;
+	
+	// A worker that dies sooner than this after starting is respawned with a delay
+	static const time_t RESPAWN_DELAY = 1;
+};
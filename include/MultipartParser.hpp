@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include "BoundaryMatcher.hpp"
+
+// Receives the parts of a multipart body as MultipartParser finds them
+class MultipartListener {
+public:
+	virtual ~MultipartListener() {}
+	
+	// A part starts; headers is its raw header block (lines end in CRLF)
+	virtual void onPartBegin(const std::string& headers) = 0;
+	
+	// Next bytes of the current part's content
+	virtual void onPartData(const char* data, size_t size) = 0;
+	
+	// The current part's content is complete
+	virtual void onPartEnd() = 0;
+};
+
+// Incremental multipart/form-data parser (RFC 2046). The body can arrive in
+// pieces of any size; part content is passed on as it is found, and only a
+// possible partial delimiter at the end of a piece (and the headers of the
+// part being started) are held between calls.
+class MultipartParser {
+public:
+	// Constructor - boundary is the Content-Type parameter (without "--")
+	MultipartParser(const std::string& boundary, MultipartListener& listener);
+	
+	// Destructor
+	~MultipartParser();
+	
+	// Parse the next body bytes; false once the body is malformed
+	bool feed(const char* data, size_t size);
+	
+	// State
+	bool isComplete() const;  // Closing delimiter seen
+	bool hasFailed() const;
+	const std::string& getErrorMessage() const;
+
+private:
+	// Non-copyable
+	MultipartParser(const MultipartParser& other);
+	MultipartParser& operator=(const MultipartParser& rhs);
+	
+	enum State {
+		MULTIPART_PREAMBLE,   // Before the first delimiter (discarded)
+		MULTIPART_DATA,       // Part content, up to the next delimiter
+		MULTIPART_BOUNDARY,   // Rest of the delimiter line: "--" closes, CRLF starts a part
+		MULTIPART_HEADERS,    // Part headers, up to an empty line
+		MULTIPART_EPILOGUE,   // After the closing delimiter (discarded)
+		MULTIPART_ERROR
+	};
+	
+	// Scanners for each state; return the bytes used
+	size_t scanContent(const char* data, size_t size);
+	size_t scanBoundary(const char* data, size_t size);
+	size_t scanHeaders(const char* data, size_t size);
+	
+	// Content bytes (passed on only inside a part)
+	void emit(const char* data, size_t size);
+	
+	// Delimiter found at the end of the content
+	void endContent();
+	
+	void fail(const std::string& message);
+	
+	// Members
+	BoundaryMatcher _delimiter;  // CRLF "--" boundary
+	MultipartListener& _listener;
+	State _state;
+	std::string _window;         // Delimiter prefix held back from the previous piece
+	std::string _line;           // Delimiter line or part headers being collected
+	size_t _lineStart;           // Start of the current header line in _line
+	std::string _errorMessage;
+	
+	// Limits
+	static const size_t MAX_BOUNDARY_LINE = 256;   // Transport padding after a delimiter
+	static const size_t MAX_PART_HEADERS = 8192;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <pthread.h>
+
+// Thin wrapper around a pthread mutex
+class Mutex {
+public:
+	// Constructor
+	Mutex();
+	
+	// Destructor
+	~Mutex();
+	
+	// Locking
+	void lock();
+	void unlock();
+
+private:
+	// Non-copyable
+	Mutex(const Mutex& other);
+	Mutex& operator=(const Mutex& rhs);
+	
+	// Members
+	pthread_mutex_t _mutex;
+};
+
+// Holds a mutex for the lifetime of the scope
+class ScopedLock {
+public:
+	// Constructor - locks the mutex
+	explicit ScopedLock(Mutex& mutex);
+	
+	// Destructor - unlocks the mutex
+	~ScopedLock();
+
+private:
+	// Non-copyable
+	ScopedLock(const ScopedLock& other);
+	ScopedLock& operator=(const ScopedLock& rhs);
+	
+	// Members
+	Mutex& _mutex;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <map>
+#include <list>
+#include <ctime>
+#include <sys/types.h>
+
+// Metadata of an open file, kept by the cache
+struct OpenFileInfo {
+	int fd;                     // Open read-only descriptor (owned by the cache)
+	off_t size;
+	time_t mtime;
+	ino_t inode;
+	std::string mimeType;
+	std::string etag;           // Precomputed validator ("mtime-size-inode")
+	std::string lastModified;   // Precomputed HTTP-date of mtime
+
+	OpenFileInfo()
+		: fd(-1),
+		  size(0),
+		  mtime(0),
+		  inode(0),
+		  mimeType(""),
+		  etag(""),
+		  lastModified("") {}
+};
+
+// LRU cache of open files keyed by resolved path (like nginx's open_file_cache)
+class OpenFileCache {
+public:
+	// Constructor
+	OpenFileCache(size_t maxEntries, time_t validSeconds);
+
+	// Destructor - closes all cached fds
+	~OpenFileCache();
+
+	// Find entry; revalidated with stat() once older than the valid interval.
+	// Returns NULL on miss or if the file changed on disk.
+	const OpenFileInfo* find(const std::string& path);
+
+	// Insert entry (cache takes ownership of info.fd), evicting the LRU entry if full
+	const OpenFileInfo* insert(const std::string& path, const OpenFileInfo& info);
+
+	// Drop entry (e.g. after DELETE)
+	void remove(const std::string& path);
+
+	// Stats
+	size_t size() const;
+
+private:
+	// Non-copyable
+	OpenFileCache(const OpenFileCache& other);
+	OpenFileCache& operator=(const OpenFileCache& rhs);
+
+	struct Entry {
+		OpenFileInfo info;
+		time_t validated;                        // Last time the entry was checked against disk
+		std::list<std::string>::iterator lruPos; // Position in _lru
+	};
+
+	typedef std::map<std::string, Entry> EntryMap;
+
+	// Close entry fd and erase it
+	void erase(EntryMap::iterator it);
+
+	// Members
+	EntryMap _entries;
+	std::list<std::string> _lru;  // Most recently used first
+	size_t _maxEntries;
+	time_t _validSeconds;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include "Lexer.hpp"
 #include "ServerConfig.hpp"
+#include "MainConfig.hpp"
 #include "LocationConfig.hpp"
 #include "ConfigError.hpp"
 #include <vector>
@@ -12,9 +13,10 @@
 
 // Directive scope categories
 enum DirectiveScope {
-	SCOPE_SERVER_ONLY,   // listen, server_name, error_page
+	SCOPE_MAIN,          // worker_processes, worker_threads (top level, outside server blocks)
+	SCOPE_SERVER_ONLY,   // listen, server_name, error_page, open_file_cache, *_timeout
 	SCOPE_LOCATION_ONLY, // return, cgi_pass, cgi_extension, upload_store, allowed_methods
-	SCOPE_BOTH           // root, index, autoindex, client_max_body_size
+	SCOPE_BOTH           // root, index, autoindex, client_max_body_size, client_body_buffer_size
 };
 
 // Directive arity
@@ -40,10 +42,24 @@ struct DirectiveSpec {
 
 // Global directive table (NOTE: 'host' removed - use 'listen interface:port' instead)
 static const DirectiveSpec g_directives[] = {
+	// Main-context directives
+	{"worker_processes",     SCOPE_MAIN,          SINGLE_VALUE, DUP_FORBIDDEN},
+	{"worker_threads",       SCOPE_MAIN,          SINGLE_VALUE, DUP_FORBIDDEN},
+	{"worker_balance",       SCOPE_MAIN,          SINGLE_VALUE, DUP_FORBIDDEN},
+	{"edge_triggered",       SCOPE_MAIN,          SINGLE_VALUE, DUP_FORBIDDEN},
+	
 	// Server-only directives
 	{"listen",               SCOPE_SERVER_ONLY,   MULTI_VALUE,  DUP_UNIQUE_KEY},
 	{"server_name",          SCOPE_SERVER_ONLY,   MULTI_VALUE,  DUP_UNIQUE_KEY},
 	{"error_page",           SCOPE_SERVER_ONLY,   MULTI_VALUE,  DUP_UNIQUE_KEY},
+	{"open_file_cache",      SCOPE_SERVER_ONLY,   SINGLE_VALUE, DUP_FORBIDDEN},
+	{"open_file_cache_valid", SCOPE_SERVER_ONLY,  SINGLE_VALUE, DUP_FORBIDDEN},
+	{"file_cache_size",      SCOPE_SERVER_ONLY,   SINGLE_VALUE, DUP_FORBIDDEN},
+	{"file_cache_max_entry", SCOPE_SERVER_ONLY,   SINGLE_VALUE, DUP_FORBIDDEN},
+	{"client_header_timeout", SCOPE_SERVER_ONLY,  SINGLE_VALUE, DUP_FORBIDDEN},
+	{"client_body_timeout",  SCOPE_SERVER_ONLY,   SINGLE_VALUE, DUP_FORBIDDEN},
+	{"keepalive_timeout",    SCOPE_SERVER_ONLY,   SINGLE_VALUE, DUP_FORBIDDEN},
+	{"send_timeout",         SCOPE_SERVER_ONLY,   SINGLE_VALUE, DUP_FORBIDDEN},
 	
 	// Location-only directives
 	{"return",               SCOPE_LOCATION_ONLY, SINGLE_VALUE, DUP_FORBIDDEN},
@@ -56,7 +72,8 @@ static const DirectiveSpec g_directives[] = {
 	{"root",                 SCOPE_BOTH,          SINGLE_VALUE, DUP_FORBIDDEN},
 	{"index",                SCOPE_BOTH,          MULTI_VALUE,  DUP_UNIQUE_KEY},
 	{"autoindex",            SCOPE_BOTH,          SINGLE_VALUE, DUP_FORBIDDEN},
-	{"client_max_body_size", SCOPE_BOTH,          SINGLE_VALUE, DUP_FORBIDDEN}
+	{"client_max_body_size", SCOPE_BOTH,          SINGLE_VALUE, DUP_FORBIDDEN},
+	{"client_body_buffer_size", SCOPE_BOTH,       SINGLE_VALUE, DUP_FORBIDDEN}
 };
 
 class Parser {
@@ -69,6 +86,9 @@ public:
 	
 	// Main parsing entry point
 	std::vector<ServerConfig> parse();
+	
+	// Main-context directives (valid after parse())
+	const MainConfig& getMainConfig() const;
 
 private:
 	// Non-copyable
@@ -78,6 +98,7 @@ private:
 	// Members
 	Lexer& _lexer;
 	Token _current;
+	MainConfig _main;
 	
 	// Token control
 	void advance();
@@ -88,16 +109,19 @@ private:
 	std::vector<Token> collectValuesUntilSemicolon();
 	
 	// Grammar
+	void parseMainDirective(std::set<std::string>& seen);
 	void parseServerBlock(std::vector<ServerConfig>& servers);
 	void parseServerDirective(ServerConfig& server, std::set<std::string>& seen);
 	void parseLocationBlock(ServerConfig& server);
 	void parseLocationDirective(LocationConfig& location, std::set<std::string>& seen);
 	
 	// Directive application
+	void applyMainDirective(const Token& name, const std::vector<Token>& values);
 	void applyServerDirective(ServerConfig& server, const Token& name, const std::vector<Token>& values);
 	void applyLocationDirective(LocationConfig& location, const Token& name, const std::vector<Token>& values);
 	
 	// Directive lookup
+	const DirectiveSpec* findDirectiveInMain(const std::string& name) const;
 	const DirectiveSpec* findDirectiveInServer(const std::string& name) const;
 	const DirectiveSpec* findDirectiveInLocation(const std::string& name) const;
 	
@@ -109,11 +133,13 @@ private:
 	bool isValidRedirectUrl(const std::string& url) const;
 	
 	// Validation & defaults
+	void applyMainDefaults();
 	void validateAndApplyDefaults(ServerConfig& server);
 	void applyServerDefaults(ServerConfig& server);
 	void applyLocationDefaults(LocationConfig& location, ServerConfig& server);
 	
 	// Debug printing
+	void debugPrintMain() const;
 	void debugPrintServers(const std::vector<ServerConfig>& servers) const;
 	void debugPrintServer(const ServerConfig& server) const;
 	void debugPrintLocation(const LocationConfig& location) const;
@@ -1,12 +1,35 @@
 #pragma once
 #include <string>
-#include <map>
+#include <vector>
 #include <sstream>
+#include <sys/types.h>
+#include "Arena.hpp"
+
+// Byte range of a file (already resolved against the file size)
+struct ByteRange {
+	off_t offset;
+	off_t length;
+	
+	ByteRange(off_t off = 0, off_t len = 0) : offset(off), length(len) {}
+};
+
+// Piece of a file body: framing bytes followed by a file range
+struct FilePart {
+	std::string prefix;  // Sent before the range (multipart delimiter + part headers)
+	off_t offset;
+	off_t length;
+	
+	FilePart() : prefix(""), offset(0), length(0) {}
+};
 
 class Response {
 public:
-	// Constructor
-	Response();
+	typedef std::pair<ArenaString, ArenaString> Header;
+	typedef std::vector<Header, ArenaAllocator<Header> > HeaderList;  // In insertion order
+	typedef std::vector<FilePart, ArenaAllocator<FilePart> > FilePartList;
+	
+	// Constructor - headers and file parts are allocated from arena (heap if NULL)
+	explicit Response(Arena* arena = NULL);
 	
 	// Destructor
 	~Response();
@@ -19,6 +42,9 @@ public:
 	void setStatusText(const std::string& text);
 	void setContentType(const std::string& type);
 	void setBody(const std::string& body);
+	void swapBody(std::string& body);        // Set body without copying (caller gets the old one)
+	void setFileBody(int fd, off_t length);  // Body streamed from fd (not owned)
+	void setFileRanges(int fd, const std::vector<ByteRange>& ranges, off_t fileSize);  // 206 body
 	void setKeepAlive(bool keepAlive);
 	
 	// Add/set headers
@@ -30,13 +56,28 @@ public:
 	const std::string& getStatusText() const;
 	const std::string& getContentType() const;
 	const std::string& getBody() const;
+	bool hasFileBody() const;
+	int getFileFd() const;
+	off_t getFileLength() const;                      // Total body bytes (incl. framing)
+	const FilePartList& getFileParts() const;
+	const std::string& getFileTrailer() const;        // Sent after the last part
 	bool isKeepAlive() const;
 	std::string getHeader(const std::string& name) const;
-	const std::map<std::string, std::string>& getHeaders() const;
+	const HeaderList& getHeaders() const;
 	
 	// Build the complete HTTP response string
+	// (headers only when the body is streamed from a file)
 	std::string build() const;
 	
+	// Build the status line and header block only
+	std::string buildHeaders() const;
+	
+	// Same, in the response's arena (no heap allocation when it has one)
+	ArenaString buildArenaHeaders() const;
+	
+	// Move the in-memory body out without copying (call after buildHeaders())
+	void takeBody(std::string& out);
+	
 	// Static factory methods for common responses
 	static Response ok(const std::string& body, const std::string& contentType = "text/html");
 	static Response created(const std::string& body, const std::string& contentType = "text/html");
@@ -51,10 +92,25 @@ public:
 	                                       const std::string& message);
 
 private:
+	// Whether the status never carries a body
+	bool isBodyless() const;
+	
+	// Append the status line and header block to head
+	template <typename String>
+	void appendHeaders(String& head) const;
+	
+	// Find header by exact name
+	Header* findHeader(const std::string& name);
+	const Header* findHeader(const std::string& name) const;
+	
 	int _statusCode;
 	std::string _statusText;
 	std::string _contentType;
 	std::string _body;
+	int _fileFd;
+	off_t _fileLength;
+	FilePartList _fileParts;
+	std::string _fileTrailer;
 	bool _keepAlive;
-	std::map<std::string, std::string> _headers;
+	HeaderList _headers;
 };
\ No newline at end of file
@@ -2,7 +2,10 @@
 #include <vector>
 #include <map>
 #include <ctime>
+#include <pthread.h>
+#include <netinet/in.h>
 #include "ServerConfig.hpp"
+#include "MainConfig.hpp"
 #include "Socket.hpp"
 #include "Epoll.hpp"
 #include "Client.hpp"
@@ -11,7 +14,11 @@
 #include "FileServer.hpp"
 #include "CgiHandler.hpp"
 #include "UploadHandler.hpp"
+#include "Response.hpp"
+#include "FdTable.hpp"
+#include "TimerWheel.hpp"
 
+// Running CGI process (heap-allocated; its pipes' fd slots point at it)
 struct CgiSession {
     Client* client;
     
@@ -20,6 +27,7 @@ struct CgiSession {
     int stdinFd;    // Write to CGI
     
     time_t startTime;
+    TimerNode timer;           // Kills the CGI after CgiHandler::getTimeout() seconds
     std::string inputBuffer;   // Request body to send to CGI
     size_t inputSent;          // How much input has been sent
     std::string outputBuffer;  // Accumulated CGI output
@@ -31,6 +39,7 @@ struct CgiSession {
     std::string clientIp;
     int clientPort;
     int serverPort;
+    bool keepAlive;            // Connection header of the response
     
     CgiSession()
         : client(NULL),
@@ -38,16 +47,26 @@ struct CgiSession {
           stdoutFd(-1),
           stdinFd(-1),
           startTime(0),
+          timer(),
           inputSent(0),
           inputComplete(false),
           clientPort(0),
-          serverPort(0) {}
+          serverPort(0),
+          keepAlive(true) {}
+};
+
+// Accepted connection passed from the accepting thread to a worker thread
+struct Handoff {
+    int fd;
+    int clientPort;
+    int listenPort;
+    char address[INET_ADDRSTRLEN];
 };
 
 class Server {
 public:
 	// Constructor
-	explicit Server(const std::vector<ServerConfig>& servers);
+	Server(const std::vector<ServerConfig>& servers, const MainConfig& main);
 	
 	// Destructor
 	~Server();
@@ -64,59 +83,95 @@ private:
 	Server(const Server& other);
 	Server& operator=(const Server& rhs);
 	
+	// Worker thread constructor - shares the root's configuration and file server
+	Server(Server& root, int index);
+	
+	// Worker threads (worker_threads > 1): the root only accepts, each
+	// shard runs its own event loop over the connections handed to it
+	static void* shardMain(void* arg);
+	void startShards();
+	void stopShards();
+	void dispatchConnection(int fd, const std::string& address, int port, int listenPort);
+	void acceptHandoffs();
+	
 	// Setup
 	void setupListenSockets();
 	void printStartupInfo() const;
 	
 	// Event loop
 	void eventLoop();
-	void checkTimeouts();
+	void expireTimers();
 	
 	// Event handlers
 	void handleNewConnection(Socket* listenSocket);
-	void handleClientEvent(const Event& event);
+	void addConnection(int fd, const std::string& address, int port, int listenPort);
+	void handleClientEvent(FdSlot* slot, const Event& event);
+	void serviceClient(FdSlot* slot);
+	void serviceReadyClients();
+	bool acceptsInput(const Client* client) const;
 	void handleClientRead(Client* client);
 	void handleClientWrite(Client* client);
-	void handleCgiEvent(const Event& event);
+	void handleCgiEvent(FdSlot* slot, const Event& event);
+	
+	// Close a client connection (detaching any CGI session still running for it)
+	void closeClient(int fd);
+	
+	// Change the events watched on a client connection
+	void watchClient(Client* client, uint32_t events);
+	
+	// Watch the events the client needs next, or close it once it is done
+	void updateClient(Client* client);
+	
+	// Arm the client's timer with the timeout of its current phase
+	void armClientTimer(Client* client);
 	
 	// Request processing
-	void processRequest(Client* client);
+	void processInput(Client* client);
+	void prepareBody(Client* client);  // Headers parsed: pick where the body goes
+	bool processRequest(Client* client);
+	void queueResponse(Client* client, Response& response);
+	void queueReservedResponse(Client* client, Response& response);
 	
 	// CGI session management
 	void startCgiSession(Client* client, const RouteResult& route);
-	void finalizeCgiSession(int cgiFd);
-	void cleanupCgiSession(int cgiFd, bool sendError);
-	void checkCgiTimeouts();
-	
-	// Helpers
-	bool isListenSocket(int fd) const;
-	bool isCgiPipe(int fd) const;
-	Socket* findListenSocket(int fd) const;
+	void finalizeCgiSession(CgiSession* session);
+	void cleanupCgiSession(CgiSession* session, bool sendError);
 	
 	// Members - Configuration
 	std::vector<ServerConfig> _servers;
+	MainConfig _main;
 	
 	// Members - Sockets
 	std::vector<Socket*> _listenSockets;
-	std::map<int, int> _fdToPort;  // Map client fd to listen port
 	
 	// Members - Core components
 	Epoll _epoll;
+	FdTable _fds;  // Listen sockets, clients (with their listen port) and CGI pipes
+	BufferPool _buffers;  // Client I/O buffers (declared before the clients that borrow them)
 	ClientManager _clientManager;
 	Router _router;
-	FileServer _fileServer;
+	FileServer* _fileServer;  // Shared by every thread of the process
+	bool _ownsFileServer;
 	CgiHandler _cgiHandler;
 	UploadHandler _uploadHandler;
-	std::map<int, CgiSession> _cgiSessions;  // Keyed by stdoutFd
-	std::map<int, int> _stdinToStdout;  // Maps stdin fd to stdout fd
-	std::map<int, int> _clientToCgi;  // Maps client fd to CGI stdout fd
+	BodyDiscard _discardBody;   // Sink of bodies nobody reads (no route, redirect)
+	
+	// Members - Worker threads
+	std::vector<Server*> _shards;
+	std::vector<pthread_t> _threads;
+	size_t _nextShard;        // Round-robin cursor
+	int _handoffPipe[2];      // Accepted fds queued for this shard
+	volatile int _load;       // Open connections, read by the accepting thread
 	
 	// Members - State
-	bool _running;
-	time_t _lastTimeoutCheck;
+	volatile bool _running;
+	TimerWheel _timers;  // Client phase timeouts and CGI deadlines
+	std::vector<int> _readyClients;  // Edge-triggered clients with I/O left (fds)
+	std::vector<int> _readyBatch;    // The ones being serviced this iteration
+	time_t _now;         // Monotonic second of the current loop iteration
 	
 	// Constants
-	static const time_t CLIENT_TIMEOUT = 60;
-	static const int EPOLL_TIMEOUT = 1000;
 	static const int MAX_KEEPALIVE_REQUESTS = 100;
+	static const size_t MAX_PIPELINE_OUTPUT = 64 * 1024;  // Queued output that pauses pipelined requests
+	static const int MAX_IO_PASSES = 16;                  // Read/write passes per wakeup (edge-triggered)
 };
\ No newline at end of file
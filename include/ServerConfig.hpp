@@ -4,6 +4,7 @@
 #include <set>
 #include <map>
 #include <stdexcept>
+#include <ctime>
 
 class LocationConfig;
 
@@ -48,6 +49,19 @@ public:
 	void addIndex(const std::string& file);
 	void setAutoIndex(bool value);
 	void setClientMaxBodySize(size_t size);
+	void setClientBodyBufferSize(size_t size);
+	
+	// Server-level file cache directives
+	void setOpenFileCache(size_t maxEntries);
+	void setOpenFileCacheValid(time_t seconds);
+	void setFileCacheSize(size_t bytes);
+	void setFileCacheMaxEntry(size_t bytes);
+	
+	// Server-level connection timeouts (seconds)
+	void setClientHeaderTimeout(time_t seconds);
+	void setClientBodyTimeout(time_t seconds);
+	void setKeepaliveTimeout(time_t seconds);
+	void setSendTimeout(time_t seconds);
 	
 	// Getters
 	const std::vector<ListenAddress>& getListenAddresses() const;
@@ -60,12 +74,30 @@ public:
 	const std::vector<std::string>& getIndex() const;
 	bool getAutoIndex() const;
 	size_t getClientMaxBodySize() const;
+	size_t getClientBodyBufferSize() const;
+	size_t getOpenFileCache() const;
+	time_t getOpenFileCacheValid() const;
+	size_t getFileCacheSize() const;
+	size_t getFileCacheMaxEntry() const;
+	time_t getClientHeaderTimeout() const;
+	time_t getClientBodyTimeout() const;
+	time_t getKeepaliveTimeout() const;
+	time_t getSendTimeout() const;
 	
 	// Presence checks
 	bool hasRoot() const;
 	bool hasIndex() const;
 	bool hasAutoIndex() const;
 	bool hasClientMaxBodySize() const;
+	bool hasClientBodyBufferSize() const;
+	bool hasOpenFileCache() const;
+	bool hasOpenFileCacheValid() const;
+	bool hasFileCacheSize() const;
+	bool hasFileCacheMaxEntry() const;
+	bool hasClientHeaderTimeout() const;
+	bool hasClientBodyTimeout() const;
+	bool hasKeepaliveTimeout() const;
+	bool hasSendTimeout() const;
 	
 	// Create a "parent" LocationConfig for inheritance
 	LocationConfig createParentConfig() const;
@@ -84,6 +116,19 @@ private:
 	std::vector<std::string> _index;
 	bool _autoindex;
 	size_t _client_max_body_size;
+	size_t _client_body_buffer_size;
+	
+	// File cache settings (0 entries = disabled)
+	size_t _open_file_cache;
+	time_t _open_file_cache_valid;
+	size_t _file_cache_size;
+	size_t _file_cache_max_entry;
+	
+	// Connection timeouts, one per phase
+	time_t _client_header_timeout;   // Whole request line + headers
+	time_t _client_body_timeout;     // Between two body reads
+	time_t _keepalive_timeout;       // Idle between requests
+	time_t _send_timeout;            // Between two response writes
 	
 	// Locations
 	std::vector<LocationConfig> _locations;
@@ -92,6 +137,15 @@ private:
 	bool _root_set;
 	bool _autoindex_set;
 	bool _client_max_body_size_set;
+	bool _client_body_buffer_size_set;
+	bool _open_file_cache_set;
+	bool _open_file_cache_valid_set;
+	bool _file_cache_size_set;
+	bool _file_cache_max_entry_set;
+	bool _client_header_timeout_set;
+	bool _client_body_timeout_set;
+	bool _keepalive_timeout_set;
+	bool _send_timeout_set;
 	
 	// Duplicate detection
 	std::set<ListenAddress> _seen_listen;
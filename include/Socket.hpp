@@ -21,6 +21,7 @@ public:
 	
 	// Socket options
 	void setReuseAddr(bool enable);
+	void setReusePort(bool enable);  // Lets every worker bind its own copy of the address
 	void setNonBlocking(bool enable);
 	
 	// Getters
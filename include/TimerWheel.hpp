@@ -0,0 +1,79 @@
+#pragma once
+#include <ctime>
+#include <cstddef>
+
+// Intrusive timer, embedded in its owner (Client, CgiSession).
+// Unlinks itself on destruction, so owners can be deleted while armed.
+struct TimerNode {
+	time_t deadline;   // Monotonic second the timer fires at
+	void* data;        // Handed back on expiry (the owner's fd slot)
+	TimerNode* prev;
+	TimerNode* next;
+	
+	TimerNode()
+		: deadline(0),
+		  data(NULL),
+		  prev(NULL),
+		  next(NULL) {}
+	
+	// Copies start unlinked
+	TimerNode(const TimerNode& other)
+		: deadline(0),
+		  data(other.data),
+		  prev(NULL),
+		  next(NULL) {}
+	
+	~TimerNode() { unlink(); }
+	
+	bool isArmed() const { return next != NULL; }
+	
+	void unlink() {
+		if (next) {
+			prev->next = next;
+			next->prev = prev;
+			prev = NULL;
+			next = NULL;
+		}
+	}
+
+private:
+	TimerNode& operator=(const TimerNode& rhs);
+};
+
+// Hashed timing wheel with one-second ticks. Arming, re-arming and
+// cancelling are O(1); expiry only visits the slots of elapsed seconds.
+// Deadlines further out than the wheel wait in their slot for later rounds.
+class TimerWheel {
+public:
+	// Constructor
+	TimerWheel();
+	
+	// Destructor - leaves remaining timers unlinked
+	~TimerWheel();
+	
+	// Arm (or re-arm) node to fire at deadline
+	void schedule(TimerNode* node, time_t deadline);
+	
+	// Disarm node
+	void cancel(TimerNode* node);
+	
+	// Unlink and return one timer due at now, or NULL when none is left
+	TimerNode* popExpired(time_t now);
+	
+	// Milliseconds until the earliest armed slot is due (-1 if no timer is armed)
+	int nextTimeout(long long nowMs) const;
+	
+	// Monotonic clock
+	static long long nowMs();
+	static time_t now();
+
+private:
+	// Non-copyable
+	TimerWheel(const TimerWheel& other);
+	TimerWheel& operator=(const TimerWheel& rhs);
+	
+	static const size_t SLOTS = 1024;  // Seconds covered by one round
+	
+	TimerNode _slots[SLOTS];  // List heads (circular, empty when pointing at themselves)
+	time_t _current;          // Next second to expire
+};
@@ -5,6 +5,9 @@
 #include "HttpRequest.hpp"
 #include "LocationConfig.hpp"
 #include "Router.hpp"
+#include "BodySink.hpp"
+#include "BodySpool.hpp"
+#include "MultipartParser.hpp"
 
 // Represents a single uploaded file
 struct UploadedFile {
@@ -41,7 +44,6 @@ struct MultipartPart {
 	std::string name;           // Form field name
 	std::string filename;       // Filename (if file upload)
 	std::string contentType;    // Content-Type of this part
-	std::string data;           // Part data/content
 	bool isFile;                // True if this part is a file upload
 	
 	MultipartPart()
@@ -49,6 +51,63 @@ struct MultipartPart {
 		  isFile(false) {}
 };
 
+class UploadHandler;
+
+// Multipart upload saved as the body arrives: file parts are written to
+// their files piece by piece, so an upload of any size holds only the
+// parser's window in memory. Files of an upload that fails or is dropped
+// before finish() are removed.
+class MultipartUpload : public BodySink, private MultipartListener {
+public:
+	// Constructor - parts larger than maxPartSize fail the upload (0: no limit)
+	MultipartUpload(UploadHandler& handler, const std::string& uploadDir,
+	                const std::string& boundary, size_t maxPartSize);
+	
+	// Destructor - removes the files unless the upload finished successfully
+	~MultipartUpload();
+	
+	// Next body bytes
+	void write(const char* data, size_t size);
+	
+	// Whole body received: outcome of the upload
+	UploadResult finish();
+
+private:
+	// Non-copyable
+	MultipartUpload(const MultipartUpload& other);
+	MultipartUpload& operator=(const MultipartUpload& rhs);
+	
+	// Parser events
+	void onPartBegin(const std::string& headers);
+	void onPartData(const char* data, size_t size);
+	void onPartEnd();
+	
+	// Stop saving: the rest of the body is discarded
+	void fail(int statusCode, const std::string& statusText, const std::string& message);
+	
+	// Drop the part being written (and its file)
+	void discardPart();
+	
+	// Members
+	UploadHandler& _handler;
+	std::string _uploadDir;
+	size_t _maxPartSize;
+	MultipartParser _parser;
+	MultipartPart _part;      // Part being received (headers only)
+	bool _inPart;             // Part content is being received
+	size_t _partSize;         // Content bytes of the current part so far
+	size_t _partCount;
+	bool _hadFiles;           // Some part was a file
+	int _fd;                  // File of the current part (-1 if not saving it)
+	UploadedFile _file;       // Current file
+	UploadResult _result;     // Files saved so far, or the failure
+	bool _failed;
+	bool _finished;
+	
+	// Maximum number of parts in single upload (later ones are ignored)
+	static const size_t MAX_FILES_PER_UPLOAD = 100;
+};
+
 class UploadHandler {
 public:
 	// Constructor
@@ -63,14 +122,20 @@ public:
 	// Check if request is multipart/form-data
 	bool isMultipartRequest(const HttpRequest& request) const;
 	
-	// Handle file upload
+	// Handle file upload (body already received, in the request or in spool)
 	UploadResult handleUpload(const HttpRequest& request,
-	                          const RouteResult& route);
+	                          const RouteResult& route,
+	                          BodySpool* spool = NULL);
 	
-	// Parse multipart/form-data body
-	bool parseMultipart(const std::string& body,
-	                    const std::string& boundary,
-	                    std::vector<MultipartPart>& parts);
+	// Start saving a multipart upload whose body is still to come, once its
+	// headers are parsed (NULL if it cannot be streamed; handleUpload then
+	// takes the complete body)
+	MultipartUpload* startUpload(const HttpRequest& request,
+	                             const RouteResult& route);
+	
+	// Spool for a raw upload's body, in the upload directory so the file can
+	// be linked into place (memoryLimit: see BodySpool)
+	BodySpool* createSpool(const RouteResult& route, size_t memoryLimit);
 	
 	// Save uploaded file to disk
 	bool saveFile(const std::string& uploadDir,
@@ -78,6 +143,15 @@ public:
 	              const std::string& data,
 	              std::string& savedPath);
 	
+	// Create a new file for an upload under a unique name (fd, or -1)
+	int createFile(const std::string& uploadDir,
+	               const std::string& filename,
+	               std::string& savedPath);
+	
+	// Parse a single multipart part's headers
+	bool parsePartHeaders(const std::string& headerSection,
+	                      MultipartPart& part) const;
+	
 	// Generate unique filename to avoid overwrites
 	std::string generateUniqueFilename(const std::string& uploadDir,
 	                                    const std::string& originalFilename) const;
@@ -101,9 +175,8 @@ private:
 	                             std::string& name,
 	                             std::string& filename) const;
 	
-	// Parse a single multipart part's headers
-	bool parsePartHeaders(const std::string& headerSection,
-	                      MultipartPart& part) const;
+	// Upload directory of the route
+	std::string getUploadDir(const RouteResult& route) const;
 	
 	// Check if directory exists and is writable
 	bool isWritableDirectory(const std::string& path) const;
@@ -114,9 +187,6 @@ private:
 	// Generate HTML response for upload result
 	std::string generateUploadResponse(const UploadResult& result) const;
 	
-	// Maximum number of files in single upload
-	static const size_t MAX_FILES_PER_UPLOAD = 100;
-	
 	// Maximum filename length
 	static const size_t MAX_FILENAME_LENGTH = 255;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <csignal>
 
 #include "Server.hpp"
+#include "Master.hpp"
 #include "Lexer.hpp"
 #include "Parser.hpp"
 #include "ConfigError.hpp"
@@ -54,11 +55,18 @@ int main(int argc, char** argv) {
 		Lexer lexer(config);
 		Parser parser(lexer);
 		std::vector<ServerConfig> servers = parser.parse();
+		const MainConfig& mainConfig = parser.getMainConfig();
 		
 		std::cout << "✓ Configuration parsed successfully!" << std::endl;
 		
+		// Several workers: the master forks and supervises them
+		if (mainConfig.getWorkerProcesses() > 1) {
+			Master master(servers, mainConfig);
+			return master.run();
+		}
+		
 		// Create and run server
-		Server server(servers);
+		Server server(servers, mainConfig);
 		g_server = &server;
 		
 		server.run();
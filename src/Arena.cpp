@@ -0,0 +1,82 @@
+#include "Arena.hpp"
+#include <cstring>
+
+// Constructor
+Arena::Arena(size_t chunkSize)
+	: _chunks(),
+	  _chunkSize(chunkSize),
+	  _currentSize(0),
+	  _offset(0),
+	  _used(0),
+	  _capacity(0) {}
+
+// Destructor
+Arena::~Arena() {
+	for (size_t i = 0; i < _chunks.size(); ++i) {
+		delete[] _chunks[i];
+	}
+}
+
+// Allocate size bytes
+void* Arena::allocate(size_t size) {
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	
+	if (_chunks.empty() || _currentSize - _offset < size) {
+		grow(size);
+	}
+	
+	void* p = _chunks.back() + _offset;
+	_offset += size;
+	_used += size;
+	return p;
+}
+
+// Copy bytes into the arena
+char* Arena::copy(const char* data, size_t length) {
+	char* p = static_cast<char*>(allocate(length + 1));
+	std::memcpy(p, data, length);
+	p[length] = '\0';
+	return p;
+}
+
+// Release every allocation
+void Arena::reset() {
+	// Several chunks last cycle: replace them with one that fits it all
+	if (_chunks.size() > 1 || _capacity > MAX_RETAINED) {
+		size_t keep = (_used <= MAX_RETAINED) ? _used : 0;
+		
+		for (size_t i = 0; i < _chunks.size(); ++i) {
+			delete[] _chunks[i];
+		}
+		_chunks.clear();
+		_capacity = 0;
+		_currentSize = 0;
+		
+		if (keep > 0) {
+			grow(keep);
+		}
+	}
+	
+	_offset = 0;
+	_used = 0;
+}
+
+// Stats
+size_t Arena::used() const {
+	return _used;
+}
+
+size_t Arena::capacity() const {
+	return _capacity;
+}
+
+// Start a chunk that fits at least size bytes
+void Arena::grow(size_t size) {
+	size_t chunkSize = (size > _chunkSize) ? size : _chunkSize;
+	
+	// new[] returns memory aligned for any fundamental type
+	_chunks.push_back(new char[chunkSize]);
+	_currentSize = chunkSize;
+	_offset = 0;
+	_capacity += chunkSize;
+}
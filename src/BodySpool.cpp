@@ -0,0 +1,197 @@
+#include "BodySpool.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+
+// Constructor
+BodySpool::BodySpool(const std::string& directory, size_t memoryLimit)
+	: _directory(directory),
+	  _memoryLimit(memoryLimit),
+	  _data(""),
+	  _fd(-1),
+	  _tempPath(""),
+	  _size(0),
+	  _failed(false),
+	  _spliceable(true) {
+	_pipe[0] = -1;
+	_pipe[1] = -1;
+}
+
+// Destructor
+BodySpool::~BodySpool() {
+	if (_fd >= 0) {
+		::close(_fd);
+	}
+	if (!_tempPath.empty()) {
+		unlink(_tempPath.c_str());
+	}
+	for (int i = 0; i < 2; ++i) {
+		if (_pipe[i] >= 0) {
+			::close(_pipe[i]);
+		}
+	}
+}
+
+// Next body bytes
+void BodySpool::write(const char* data, size_t size) {
+	_size += size;
+	if (_failed) {
+		return;
+	}
+	
+	if (_fd < 0) {
+		if (_data.size() + size <= _memoryLimit) {
+			_data.append(data, size);
+			return;
+		}
+		if (!spill()) {
+			_failed = true;
+			return;
+		}
+	}
+	if (!writeFile(data, size)) {
+		_failed = true;
+	}
+}
+
+// Move socket bytes into the file
+ssize_t BodySpool::splice(int fd, size_t max) {
+	if (!canSplice()) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (_fd < 0 && !spill()) {
+		_failed = true;
+		errno = EIO;
+		return -1;
+	}
+	if (_pipe[0] < 0 && pipe2(_pipe, O_CLOEXEC) != 0) {
+		_spliceable = false;
+		return -1;
+	}
+	
+	size_t chunk = (max < SPLICE_CHUNK) ? max : SPLICE_CHUNK;
+	ssize_t moved = ::splice(fd, NULL, _pipe[1], NULL, chunk, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+	if (moved < 0 && (errno == EINVAL || errno == ENOSYS)) {
+		_spliceable = false;  // Not a socket splice() can read from
+	}
+	if (moved <= 0) {
+		return moved;
+	}
+	_size += static_cast<size_t>(moved);
+	
+	// The pipe was empty, so all of it fits and is on its way to the file
+	size_t left = static_cast<size_t>(moved);
+	while (left > 0) {
+		ssize_t out = ::splice(_pipe[0], NULL, _fd, NULL, left, SPLICE_F_MOVE);
+		if (out < 0 && errno == EINTR) {
+			continue;
+		}
+		if (out <= 0) {
+			// The filesystem does not take splice(): copy the rest, then read()
+			_spliceable = false;
+			drainPipe(left);
+			break;
+		}
+		left -= static_cast<size_t>(out);
+	}
+	return moved;
+}
+
+// Copy the pipe's bytes to the file
+void BodySpool::drainPipe(size_t size) {
+	char buffer[4096];
+	while (size > 0) {
+		size_t chunk = (size < sizeof(buffer)) ? size : sizeof(buffer);
+		ssize_t got = ::read(_pipe[0], buffer, chunk);
+		if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		if (got <= 0) {
+			_failed = true;
+			return;
+		}
+		if (!writeFile(buffer, static_cast<size_t>(got))) {
+			_failed = true;
+		}
+		size -= static_cast<size_t>(got);
+	}
+}
+
+// Create the file
+bool BodySpool::spill() {
+#ifdef O_TMPFILE
+	_fd = open(_directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0644);
+#endif
+	if (_fd < 0) {
+		// No O_TMPFILE (kernel or filesystem): a named file, removed when done
+		std::string path = _directory;
+		if (path.empty() || path[path.size() - 1] != '/') {
+			path += '/';
+		}
+		path += ".body-XXXXXX";
+		
+		std::vector<char> name(path.begin(), path.end());
+		name.push_back('\0');
+		_fd = mkostemp(&name[0], O_CLOEXEC);
+		if (_fd < 0) {
+			return false;
+		}
+		_tempPath = &name[0];
+	}
+	
+	bool written = writeFile(_data.data(), _data.size());
+	std::string().swap(_data);
+	return written;
+}
+
+// Append to the file
+bool BodySpool::writeFile(const char* data, size_t size) {
+	while (size > 0) {
+		ssize_t written = ::write(_fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+// Give the file a name
+bool BodySpool::linkTo(const std::string& path) {
+	if (_fd < 0 || _failed) {
+		return false;
+	}
+	
+	if (!_tempPath.empty()) {
+		// mkstemp() files are private (0600); give it the mode of other uploads
+		if (fchmod(_fd, 0644) != 0 || link(_tempPath.c_str(), path.c_str()) != 0) {
+			return false;
+		}
+		unlink(_tempPath.c_str());
+		_tempPath.clear();
+		return true;
+	}
+	
+	// An O_TMPFILE file is linked through its /proc entry (linkat() with
+	// AT_EMPTY_PATH would need CAP_DAC_READ_SEARCH)
+	char procPath[64];
+	snprintf(procPath, sizeof(procPath), "/proc/self/fd/%d", _fd);
+	return linkat(AT_FDCWD, procPath, AT_FDCWD, path.c_str(), AT_SYMLINK_FOLLOW) == 0;
+}
+
+// Getters
+bool BodySpool::isFile() const { return _fd >= 0; }
+int BodySpool::getFd() const { return _fd; }
+const std::string& BodySpool::getData() const { return _data; }
+size_t BodySpool::size() const { return _size; }
+bool BodySpool::hasFailed() const { return _failed; }
+bool BodySpool::canSplice() const { return _spliceable && !_failed; }
@@ -0,0 +1,84 @@
+#include "BoundaryMatcher.hpp"
+#include <cstring>
+
+// Constructor
+BoundaryMatcher::BoundaryMatcher(const std::string& pattern)
+	: _pattern(pattern) {
+	const size_t length = _pattern.size();
+	
+	// Bytes absent from the pattern (last position aside) skip a whole window
+	for (size_t c = 0; c < 256; ++c) {
+		_skip[c] = length;
+	}
+	for (size_t i = 0; i + 1 < length; ++i) {
+		_skip[static_cast<unsigned char>(_pattern[i])] = length - 1 - i;
+	}
+}
+
+// Destructor
+BoundaryMatcher::~BoundaryMatcher() {}
+
+// First complete match
+size_t BoundaryMatcher::find(const char* data, size_t size) const {
+	const size_t length = _pattern.size();
+	if (size < length) {
+		return size;
+	}
+	
+	const char first = _pattern[0];
+	const char* p = data;
+	const char* last = data + (size - length);  // Last possible match start
+	size_t misses = 0;
+	
+	while (p <= last) {
+		p = static_cast<const char*>(std::memchr(p, first, static_cast<size_t>(last - p) + 1));
+		if (!p) {
+			return size;
+		}
+		if (std::memcmp(p + 1, _pattern.data() + 1, length - 1) == 0) {
+			return static_cast<size_t>(p - data);
+		}
+		++p;
+		
+		// The first byte is common in this data: memchr() stops too often
+		size_t scanned = static_cast<size_t>(p - data);
+		if (++misses > PREFILTER_MISSES + scanned / PREFILTER_BYTES_PER_MISS) {
+			return findHorspool(data, size, scanned);
+		}
+	}
+	return size;
+}
+
+// Boyer-Moore-Horspool: compare the window's last byte, then the rest;
+// shift by the skip distance of the byte under the last position
+size_t BoundaryMatcher::findHorspool(const char* data, size_t size, size_t from) const {
+	const size_t length = _pattern.size();
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	const unsigned char lastByte = static_cast<unsigned char>(_pattern[length - 1]);
+	
+	for (size_t i = from; i + length <= size; ) {
+		unsigned char c = bytes[i + length - 1];
+		if (c == lastByte && std::memcmp(data + i, _pattern.data(), length - 1) == 0) {
+			return i;
+		}
+		i += _skip[c];
+	}
+	return size;
+}
+
+// Pattern prefix at the end of data
+size_t BoundaryMatcher::findPrefix(const char* data, size_t size) const {
+	const size_t length = _pattern.size();
+	size_t from = (size >= length) ? size - length + 1 : 0;
+	
+	for (size_t i = from; i < size; ++i) {
+		if (data[i] == _pattern[0] && std::memcmp(data + i, _pattern.data(), size - i) == 0) {
+			return i;
+		}
+	}
+	return size;
+}
+
+// Pattern
+const char* BoundaryMatcher::data() const { return _pattern.data(); }
+size_t BoundaryMatcher::size() const { return _pattern.size(); }
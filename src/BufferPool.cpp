@@ -0,0 +1,61 @@
+#include "BufferPool.hpp"
+
+// Constructor
+BufferPool::BufferPool()
+	: _slabs(),
+	  _free(NULL),
+	  _inUse(0) {}
+
+// Destructor
+BufferPool::~BufferPool() {
+	for (size_t i = 0; i < _slabs.size(); ++i) {
+		delete[] _slabs[i];
+	}
+}
+
+// Borrow a buffer
+char* BufferPool::acquire() {
+	if (!_free) {
+		grow();
+	}
+	
+	FreeBuffer* buffer = _free;
+	_free = buffer->next;
+	++_inUse;
+	return reinterpret_cast<char*>(buffer);
+}
+
+// Give a buffer back
+void BufferPool::release(char* buffer) {
+	if (!buffer) {
+		return;
+	}
+	
+	FreeBuffer* node = reinterpret_cast<FreeBuffer*>(buffer);
+	node->next = _free;
+	_free = node;
+	--_inUse;
+}
+
+// Stats
+size_t BufferPool::inUse() const {
+	return _inUse;
+}
+
+size_t BufferPool::capacity() const {
+	return _slabs.size() * BUFFERS_PER_SLAB;
+}
+
+// Add a slab to the free list
+void BufferPool::grow() {
+	// new[] returns memory aligned for any fundamental type, and BUFFER_SIZE
+	// keeps every buffer in the slab equally aligned
+	char* slab = new char[BUFFER_SIZE * BUFFERS_PER_SLAB];
+	_slabs.push_back(slab);
+	
+	for (size_t i = BUFFERS_PER_SLAB; i > 0; --i) {
+		FreeBuffer* node = reinterpret_cast<FreeBuffer*>(slab + (i - 1) * BUFFER_SIZE);
+		node->next = _free;
+		_free = node;
+	}
+}
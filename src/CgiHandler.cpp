@@ -162,10 +162,10 @@ std::vector<std::string> CgiHandler::buildEnvironment(const HttpRequest& request
 	// Content info (for POST requests)
 	if (request.getMethod() == "POST") {
 		ss.str("");
-		ss << "CONTENT_LENGTH=" << request.getBody().size();
+		ss << "CONTENT_LENGTH=" << request.getBodySize();
 		env.push_back(ss.str());
 		
-		std::string contentType = request.getHeader("Content-Type");
+		const std::string& contentType = request.getHeader(HEADER_CONTENT_TYPE);
 		if (!contentType.empty()) {
 			env.push_back("CONTENT_TYPE=" + contentType);
 		}
@@ -173,25 +173,24 @@ std::vector<std::string> CgiHandler::buildEnvironment(const HttpRequest& request
 	
 	// Convert HTTP headers to environment variables
 	// HTTP_* format (header name uppercase, dashes become underscores)
-	const std::map<std::string, std::string>& headers = request.getHeaders();
-	for (std::map<std::string, std::string>::const_iterator it = headers.begin();
-	     it != headers.end(); ++it) {
+	for (int h = 0; h < HEADER_COUNT; ++h) {
+		HttpHeader header = static_cast<HttpHeader>(h);
+		
 		// Skip Content-Type and Content-Length (already handled)
-		if (it->first == "content-type" || it->first == "content-length") {
+		if (!request.hasHeader(header) ||
+		    header == HEADER_CONTENT_TYPE || header == HEADER_CONTENT_LENGTH) {
 			continue;
 		}
-		
-		// Convert header name: lowercase to uppercase, - to _
-		std::string envName = "HTTP_";
-		for (size_t i = 0; i < it->first.size(); ++i) {
-			char c = it->first[i];
-			if (c == '-') {
-				envName += '_';
-			} else {
-				envName += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-			}
-		}
-		env.push_back(envName + "=" + it->second);
+		const char* name = HttpRequest::headerName(header);
+		const std::string& value = request.getHeader(header);
+		env.push_back(buildHeaderVariable(name, std::strlen(name), value.data(), value.size()));
+	}
+	
+	const HttpRequest::HeaderList& otherHeaders = request.getOtherHeaders();
+	for (size_t i = 0; i < otherHeaders.size(); ++i) {
+		const HeaderField& field = otherHeaders[i];
+		env.push_back(buildHeaderVariable(field.name, field.nameLength,
+		                                  field.value, field.valueLength));
 	}
 	
 	// Preserve some system environment variables
@@ -213,6 +212,23 @@ std::vector<std::string> CgiHandler::buildEnvironment(const HttpRequest& request
 	return env;
 }
 
+// Build HTTP_* variable for a header
+std::string CgiHandler::buildHeaderVariable(const char* name, size_t nameLength,
+                                            const char* value, size_t valueLength) {
+	std::string variable = "HTTP_";
+	for (size_t i = 0; i < nameLength; ++i) {
+		char c = name[i];
+		if (c == '-') {
+			variable += '_';
+		} else {
+			variable += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+		}
+	}
+	variable += '=';
+	variable.append(value, valueLength);
+	return variable;
+}
+
 // Convert vector to envp array
 char** CgiHandler::vectorToEnvp(const std::vector<std::string>& env) const {
 	char** envp = new char*[env.size() + 1];
@@ -365,7 +381,8 @@ CgiStartResult CgiHandler::startNonBlocking(const HttpRequest& request,
                                             const RouteResult& route,
                                             const std::string& clientIp,
                                             int clientPort,
-                                            int serverPort) {
+                                            int serverPort,
+                                            int bodyFd) {
 	CgiStartResult result;
 	
 	// Validate route
@@ -406,19 +423,19 @@ CgiStartResult CgiHandler::startNonBlocking(const HttpRequest& request,
 		return result;
 	}
 	
-	// Create pipes
-	int pipeIn[2];   // Parent writes, child reads (stdin)
-	int pipeOut[2];  // Child writes, parent reads (stdout)
+	// Create pipes (close-on-exec, so CGIs forked by other threads never hold our
+	// ends open; dup2() onto stdin/stdout clears the flag in the child)
+	int pipeIn[2] = { -1, -1 };  // Parent writes, child reads (stdin), unless bodyFd is
+	int pipeOut[2];              // Child writes, parent reads (stdout)
 	
-	if (pipe(pipeIn) < 0) {
+	if (bodyFd < 0 && pipe2(pipeIn, O_CLOEXEC) < 0) {
 		result.errorMessage = "Failed to create input pipe";
 		result.errorCode = 500;
 		return result;
 	}
 	
-	if (pipe(pipeOut) < 0) {
-		close(pipeIn[0]);
-		close(pipeIn[1]);
+	if (pipe2(pipeOut, O_CLOEXEC) < 0) {
+		closePipe(pipeIn);
 		result.errorMessage = "Failed to create output pipe";
 		result.errorCode = 500;
 		return result;
@@ -429,15 +446,18 @@ CgiStartResult CgiHandler::startNonBlocking(const HttpRequest& request,
 	                                                    clientIp, clientPort, serverPort);
 	char** envp = vectorToEnvp(envVec);
 	
+	// The script reads the body file from the start (the offset is shared)
+	if (bodyFd >= 0) {
+		lseek(bodyFd, 0, SEEK_SET);
+	}
+	
 	// Fork
 	pid_t pid = fork();
 	
 	if (pid < 0) {
 		// Fork failed
-		close(pipeIn[0]);
-		close(pipeIn[1]);
-		close(pipeOut[0]);
-		close(pipeOut[1]);
+		closePipe(pipeIn);
+		closePipe(pipeOut);
 		freeEnvp(envp);
 		result.errorMessage = "Failed to fork CGI process";
 		result.errorCode = 500;
@@ -447,10 +467,14 @@ CgiStartResult CgiHandler::startNonBlocking(const HttpRequest& request,
 	if (pid == 0) {
 		// Child process
 		
-		// Redirect stdin to pipeIn
-		close(pipeIn[1]);  // Close write end
-		dup2(pipeIn[0], STDIN_FILENO);
-		close(pipeIn[0]);
+		// Redirect stdin to the body file, or to pipeIn
+		if (bodyFd >= 0) {
+			dup2(bodyFd, STDIN_FILENO);
+		} else {
+			close(pipeIn[1]);  // Close write end
+			dup2(pipeIn[0], STDIN_FILENO);
+			close(pipeIn[0]);
+		}
 		
 		// Redirect stdout to pipeOut
 		close(pipeOut[0]);  // Close read end
@@ -488,11 +512,15 @@ CgiStartResult CgiHandler::startNonBlocking(const HttpRequest& request,
 	freeEnvp(envp);
 	
 	// Close unused ends
-	close(pipeIn[0]);   // Close read end of input pipe
+	if (pipeIn[0] >= 0) {
+		close(pipeIn[0]);   // Close read end of input pipe
+	}
 	close(pipeOut[1]);  // Close write end of output pipe
 	
 	// Set pipes to non-blocking
-	setNonBlocking(pipeIn[1]);
+	if (pipeIn[1] >= 0) {
+		setNonBlocking(pipeIn[1]);
+	}
 	setNonBlocking(pipeOut[0]);
 	
 	// Return the FDs and PID
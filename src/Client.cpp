@@ -1,88 +1,425 @@
 #include "Client.hpp"
+#include "UploadHandler.hpp"
+#include "BodySpool.hpp"
 #include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
 #include <cerrno>
 #include <cstring>
 #include <iostream>
 
 // Constructor
-Client::Client(int fd, const std::string& address, int port)
+Client::Client(int fd, const std::string& address, int port, BufferPool& pool)
 	: _fd(fd),
 	  _address(address),
 	  _port(port),
 	  _state(STATE_READING_REQUEST),
-	  _readBuffer(""),
-	  _writeBuffer(""),
-	  _writeOffset(0),
-	  _lastActivity(std::time(NULL)),
+	  _pool(pool),
+	  _input(NULL),
+	  _inputStart(0),
+	  _inputEnd(0),
+	  _outputSize(0),
+	  _fileWindowMode(false),
+	  _fileWindowOffset(0),
+	  _fileWindowSent(0),
+	  _readReady(false),
+	  _writeReady(true),   // A new socket has room to send
+	  _readyListed(false),
+	  _timer(),
+	  _timeoutPhase(TIMEOUT_NONE),
 	  _serverConfig(NULL),
+	  _arena(),
+	  _request(_arena),
+	  _upload(NULL),
+	  _spool(NULL),
 	  _keepAlive(true),  // HTTP/1.1 defaults to keep-alive
 	  _requestCount(0) {}
 
 // Destructor
 Client::~Client() {
+	delete _upload;  // An unfinished upload removes its files
+	delete _spool;
+	clearReadBuffer();
+	clearWriteBuffer();
 	if (_fd >= 0) {
 		::close(_fd);
 		_fd = -1;
 	}
 }
 
-// Read data from socket into buffer
+// Read data from socket straight into the pooled input buffer
 ssize_t Client::readData() {
-	char buffer[8192];
+	if (!_input) {
+		_input = _pool.acquire();
+		_inputStart = 0;
+		_inputEnd = 0;
+	}
+	
+	// Compact once the consumed prefix outweighs the pending input, or the tail is full
+	if (_inputStart > 0 && (_inputEnd == BufferPool::BUFFER_SIZE ||
+	                        _inputStart >= _inputEnd - _inputStart)) {
+		std::memmove(_input, _input + _inputStart, _inputEnd - _inputStart);
+		_inputEnd -= _inputStart;
+		_inputStart = 0;
+	}
+	
+	// Unparsed input fills the buffer (the parser's line limits keep this from happening)
+	if (_inputEnd == BufferPool::BUFFER_SIZE) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	
+	ssize_t bytesRead = ::read(_fd, _input + _inputEnd, BufferPool::BUFFER_SIZE - _inputEnd);
 	
-	ssize_t bytesRead = ::read(_fd, buffer, sizeof(buffer));
+	if (bytesRead > 0) {
+		_inputEnd += static_cast<size_t>(bytesRead);
+		return bytesRead;
+	}
+	
+	if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		_readReady = false;
+	}
+	if (_inputStart == _inputEnd) {
+		clearReadBuffer();
+	}
+	
+	return bytesRead;
+}
+
+// Whether the rest of the body can bypass the input buffer
+bool Client::canSpliceBody() const {
+	return _spool && _spool->canSplice() && _request.getState() == PARSE_BODY &&
+	       _inputStart == _inputEnd;
+}
+
+// Move body bytes from socket to the spool file, never past the body's end
+ssize_t Client::spliceBody() {
+	size_t remaining = _request.getContentLength() - _request.getBodySize();
+	ssize_t bytesRead = _spool->splice(_fd, remaining);
 	
 	if (bytesRead > 0) {
-		_readBuffer.append(buffer, bytesRead);
-		updateLastActivity();
+		_request.addSplicedBody(static_cast<size_t>(bytesRead));
+		return bytesRead;
 	}
 	
+	if (bytesRead < 0 && !_spool->canSplice()) {
+		return readData();  // Unsupported here: the parser takes it from now on
+	}
+	if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		_readReady = false;
+	}
 	return bytesRead;
 }
 
-// Write data from buffer to socket
+// Write pending segments to socket, in order, until one would block
 ssize_t Client::writeData() {
-	if (_writeOffset >= _writeBuffer.size()) {
-		return 0;  // Nothing to write
+	ssize_t total = 0;
+	
+	while (!_output.empty() && !_output.front().reserved) {
+		ssize_t written;
+		
+		if (_output.front().fd < 0) {
+			// Gather consecutive memory segments into one writev()
+			written = writeMemory();
+			if (written < 0) {
+				return (total > 0) ? total : written;
+			}
+			total += written;
+			
+			// Socket is full - wait for next writable event
+			if (!_output.empty() && _output.front().fd < 0) {
+				break;
+			}
+		} else {
+			OutputSegment& segment = _output.front();
+			written = writeFile(segment);
+			if (written < 0) {
+				return (total > 0) ? total : written;
+			}
+			total += written;
+			
+			// Socket is full - wait for next writable event
+			if (segment.fileRemaining > 0) {
+				break;
+			}
+			popSegment();
+		}
 	}
 	
-	size_t remaining = _writeBuffer.size() - _writeOffset;
-	const char* data = _writeBuffer.c_str() + _writeOffset;
+	return total;
+}
+
+// Write the leading memory segments to socket with a single writev()
+ssize_t Client::writeMemory() {
+	struct iovec iov[MAX_IOV];
+	int count = 0;
 	
-	ssize_t bytesWritten = ::write(_fd, data, remaining);
-	if (bytesWritten > 0) {
-		_writeOffset += bytesWritten;
-		updateLastActivity();
+	for (std::deque<OutputSegment>::iterator it = _output.begin();
+	     it != _output.end() && it->fd < 0 && !it->reserved && count < MAX_IOV; ++it) {
+		iov[count].iov_base = const_cast<char*>(it->bytes()) + it->dataOffset;
+		iov[count].iov_len = it->size() - it->dataOffset;
+		++count;
+	}
+	
+	ssize_t bytesWritten = ::writev(_fd, iov, count);
+	if (bytesWritten < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			_writeReady = false;
+			return 0;
+		}
+		return bytesWritten;
+	}
+	
+	_outputSize -= bytesWritten;
+	
+	// Advance through the segments covered by the write
+	size_t left = static_cast<size_t>(bytesWritten);
+	while (left > 0) {
+		OutputSegment& segment = _output.front();
+		size_t pending = segment.size() - segment.dataOffset;
+		if (left < pending) {
+			segment.dataOffset += left;
+			break;
+		}
+		left -= pending;
+		segment.dataOffset = segment.size();
+		popSegment();
+	}
+	
+	return bytesWritten;
+}
+
+// Send a file segment to socket (zero-copy)
+ssize_t Client::writeFile(OutputSegment& segment) {
+	if (_fileWindowMode) {
+		return writeFileWindow(segment);
+	}
+	
+	size_t toSend = SENDFILE_CHUNK;
+	if (segment.fileRemaining < static_cast<off_t>(toSend)) {
+		toSend = static_cast<size_t>(segment.fileRemaining);
+	}
+	
+	ssize_t bytesSent = ::sendfile(_fd, segment.fd, &segment.fileOffset, toSend);
+	if (bytesSent > 0) {
+		segment.fileRemaining -= bytesSent;
+		_outputSize -= bytesSent;
+	} else if (bytesSent == 0) {
+		// File shrank while sending - nothing more can be sent
+		return -1;
+	} else if (errno == EINVAL || errno == ENOSYS) {
+		// Filesystem doesn't support sendfile() - fall back to read-ahead window
+		_fileWindowMode = true;
+		return writeFileWindow(segment);
+	} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+		_writeReady = false;
+		return 0;
+	}
+	
+	return bytesSent;
+}
+
+// Send a file segment through a fixed-size window (memory stays constant per download)
+ssize_t Client::writeFileWindow(OutputSegment& segment) {
+	// Start reading where sendfile() would have
+	if (_fileWindow.empty()) {
+		_fileWindowOffset = segment.fileOffset;
+		_fileWindowSent = 0;
+	}
+	
+	// Refill window once the socket has drained it
+	if (_fileWindowSent >= _fileWindow.size()) {
+		size_t toRead = FILE_WINDOW_SIZE;
+		if (segment.fileRemaining < static_cast<off_t>(toRead)) {
+			toRead = static_cast<size_t>(segment.fileRemaining);
+		}
 		
-		// If all data written, clear buffer
-		if (_writeOffset >= _writeBuffer.size()) {
-			clearWriteBuffer();
+		_fileWindow.resize(toRead);
+		ssize_t bytesRead = ::pread(segment.fd, &_fileWindow[0], toRead, _fileWindowOffset);
+		if (bytesRead <= 0) {
+			// Read error, or file shrank while sending
+			return -1;
 		}
+		_fileWindow.resize(static_cast<size_t>(bytesRead));
+		_fileWindowSent = 0;
+		_fileWindowOffset += bytesRead;
+	}
+	
+	ssize_t bytesWritten = ::write(_fd, _fileWindow.data() + _fileWindowSent,
+	                               _fileWindow.size() - _fileWindowSent);
+	if (bytesWritten > 0) {
+		_fileWindowSent += bytesWritten;
+		segment.fileOffset += bytesWritten;
+		segment.fileRemaining -= bytesWritten;
+		_outputSize -= bytesWritten;
+	} else if (bytesWritten < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		_writeReady = false;
+		return 0;
 	}
 	
 	return bytesWritten;
 }
 
-// Buffer management
-void Client::appendToReadBuffer(const char* data, size_t len) {
-	_readBuffer.append(data, len);
+// Drop the finished front segment
+void Client::popSegment() {
+	OutputSegment& segment = _output.front();
+	
+	_outputSize -= (segment.size() - segment.dataOffset) +
+	               static_cast<size_t>(segment.fileRemaining);
+	if (segment.buffer) {
+		_pool.release(segment.buffer);
+	}
+	if (segment.ownsFd && segment.fd >= 0) {
+		::close(segment.fd);
+	}
+	if (segment.fd >= 0) {
+		// Window belongs to this segment
+		_fileWindow.clear();
+		_fileWindowSent = 0;
+	}
+	_output.pop_front();
+}
+
+// Readiness
+void Client::setReadReady(bool ready) {
+	_readReady = ready;
+}
+
+void Client::setWriteReady(bool ready) {
+	_writeReady = ready;
 }
 
+bool Client::isReadReady() const {
+	return _readReady;
+}
+
+bool Client::isWriteReady() const {
+	return _writeReady;
+}
+
+void Client::setReadyListed(bool listed) {
+	_readyListed = listed;
+}
+
+bool Client::isReadyListed() const {
+	return _readyListed;
+}
+
+// Buffer management
 void Client::appendToWriteBuffer(const char* data, size_t len) {
-	_writeBuffer.append(data, len);
+	_outputSize += len;
+	
+	// Fill the trailing pooled segment, then borrow more buffers as needed
+	while (len > 0) {
+		if (_output.empty() || !_output.back().buffer ||
+		    _output.back().length == BufferPool::BUFFER_SIZE) {
+			_output.push_back(OutputSegment());
+			_output.back().buffer = _pool.acquire();
+		}
+		
+		OutputSegment& segment = _output.back();
+		size_t toCopy = BufferPool::BUFFER_SIZE - segment.length;
+		if (len < toCopy) {
+			toCopy = len;
+		}
+		std::memcpy(segment.buffer + segment.length, data, toCopy);
+		segment.length += toCopy;
+		data += toCopy;
+		len -= toCopy;
+	}
 }
 
 void Client::appendToWriteBuffer(const std::string& data) {
-	_writeBuffer.append(data);
+	appendToWriteBuffer(data.data(), data.size());
+}
+
+void Client::appendSegment(std::string& data) {
+	if (data.empty()) {
+		return;
+	}
+	
+	// Small bodies ride along in the pooled buffer holding the headers
+	if (!_output.empty() && _output.back().buffer &&
+	    data.size() <= BufferPool::BUFFER_SIZE - _output.back().length) {
+		appendToWriteBuffer(data.data(), data.size());
+		std::string().swap(data);
+		return;
+	}
+	
+	_output.push_back(OutputSegment());
+	_output.back().data.swap(data);
+	_outputSize += _output.back().data.size();
+}
+
+void Client::consumeReadBuffer(size_t len) {
+	_inputStart += len;
+	if (_inputStart >= _inputEnd) {
+		clearReadBuffer();  // Nothing pending - hand the buffer back
+	}
 }
 
 void Client::clearReadBuffer() {
-	_readBuffer.clear();
+	if (_input) {
+		_pool.release(_input);
+		_input = NULL;
+	}
+	_inputStart = 0;
+	_inputEnd = 0;
 }
 
 void Client::clearWriteBuffer() {
-	_writeBuffer.clear();
-	_writeOffset = 0;
+	while (!_output.empty()) {
+		popSegment();
+	}
+	_outputSize = 0;
+	_fileWindowMode = false;
+	std::string().swap(_fileWindow);  // Release window memory
+	_fileWindowSent = 0;
+}
+
+// Queue a file range
+void Client::appendFileSegment(int fd, off_t offset, off_t length, bool ownsFd) {
+	if (length <= 0) {
+		if (ownsFd && fd >= 0) {
+			::close(fd);
+		}
+		return;
+	}
+	
+	_output.push_back(OutputSegment());
+	OutputSegment& segment = _output.back();
+	segment.fd = fd;
+	segment.fileOffset = offset;
+	segment.fileRemaining = length;
+	segment.ownsFd = ownsFd;
+	_outputSize += static_cast<size_t>(length);
+}
+
+// Hold the place of a response produced later
+void Client::reserveOutput() {
+	_output.push_back(OutputSegment());
+	_output.back().reserved = true;
+}
+
+// Set aside the output queued after the reserved place and drop the place,
+// so what is queued next lands where the place was
+void Client::beginReservedOutput() {
+	while (!_output.empty() && !_output.back().reserved) {
+		_heldOutput.push_front(OutputSegment());
+		_heldOutput.front().swap(_output.back());
+		_output.pop_back();
+	}
+	if (!_output.empty()) {
+		_output.pop_back();
+	}
+}
+
+void Client::endReservedOutput() {
+	while (!_heldOutput.empty()) {
+		_output.push_back(OutputSegment());
+		_output.back().swap(_heldOutput.front());
+		_heldOutput.pop_front();
+	}
 }
 
 // Getters
@@ -102,28 +439,24 @@ int Client::getPort() const {
 	return _port;
 }
 
-const std::string& Client::getReadBuffer() const {
-	return _readBuffer;
-}
-
-const std::string& Client::getWriteBuffer() const {
-	return _writeBuffer;
+const char* Client::getReadData() const {
+	return _input ? _input + _inputStart : "";
 }
 
 size_t Client::getReadBufferSize() const {
-	return _readBuffer.size();
+	return _inputEnd - _inputStart;
 }
 
 size_t Client::getWriteBufferSize() const {
-	return _writeBuffer.size() - _writeOffset;
+	return _outputSize;
 }
 
-time_t Client::getLastActivity() const {
-	return _lastActivity;
+bool Client::hasDataToWrite() const {
+	return !_output.empty() && !_output.front().reserved;
 }
 
-bool Client::hasDataToWrite() const {
-	return _writeOffset < _writeBuffer.size();
+bool Client::hasPendingOutput() const {
+	return !_output.empty();
 }
 
 // Setters
@@ -131,10 +464,6 @@ void Client::setState(ClientState state) {
 	_state = state;
 }
 
-void Client::updateLastActivity() {
-	_lastActivity = std::time(NULL);
-}
-
 // Server config association
 void Client::setServerConfig(const ServerConfig* config) {
 	_serverConfig = config;
@@ -153,9 +482,44 @@ const HttpRequest& Client::getRequest() const {
 	return _request;
 }
 
-// Timeout check
-bool Client::isTimedOut(time_t timeout) const {
-	return (std::time(NULL) - _lastActivity) > timeout;
+// Per-request allocator
+Arena& Client::getArena() {
+	return _arena;
+}
+
+// Streamed upload
+void Client::setUpload(MultipartUpload* upload) {
+	delete _upload;
+	_upload = upload;
+	_request.setBodySink(upload);
+}
+
+MultipartUpload* Client::getUpload() {
+	return _upload;
+}
+
+// Spooled body
+void Client::setSpool(BodySpool* spool) {
+	delete _spool;
+	_spool = spool;
+	_request.setBodySink(spool);
+}
+
+BodySpool* Client::getSpool() {
+	return _spool;
+}
+
+// Inactivity timer
+TimerNode& Client::getTimer() {
+	return _timer;
+}
+
+ClientTimeout Client::getTimeoutPhase() const {
+	return _timeoutPhase;
+}
+
+void Client::setTimeoutPhase(ClientTimeout phase) {
+	_timeoutPhase = phase;
 }
 
 // Keep-alive
@@ -176,13 +540,13 @@ int Client::getRequestCount() const {
 	return _requestCount;
 }
 
-// Reset for keep-alive
+// Reset for the next request (pipelined input stays buffered)
 void Client::reset() {
 	_state = STATE_READING_REQUEST;
-	_readBuffer.clear();
-	_writeBuffer.clear();
-	_writeOffset = 0;
-	_serverConfig = NULL;
 	_request.reset();
-	updateLastActivity();
+	delete _upload;
+	_upload = NULL;
+	delete _spool;
+	_spool = NULL;
+	_arena.reset();
 }
\ No newline at end of file
@@ -1,101 +1,81 @@
 #include "ClientManager.hpp"
-#include <iostream>
 
 // Constructor
-ClientManager::ClientManager(Epoll& epoll)
-	: _epoll(epoll) {}
+ClientManager::ClientManager(Epoll& epoll, FdTable& fds, BufferPool& buffers)
+	: _epoll(epoll),
+	  _fds(fds),
+	  _buffers(buffers),
+	  _clientCount(0) {}
 
 // Destructor
 ClientManager::~ClientManager() {
 	// Clean up all clients
-	for (std::map<int, Client*>::iterator it = _clients.begin(); 
-	     it != _clients.end(); ++it) {
-		_epoll.remove(it->first);
-		delete it->second;
+	std::vector<int> fds = getAllClientFds();
+	for (size_t i = 0; i < fds.size(); ++i) {
+		removeClient(fds[i]);
 	}
-	_clients.clear();
 }
 
 // Add a new client
-Client* ClientManager::addClient(int fd, const std::string& address, int port) {
+FdSlot* ClientManager::addClient(int fd, const std::string& address, int port, uint32_t events) {
 	// Check if already exists
-	if (_clients.find(fd) != _clients.end()) {
-		return _clients[fd];
+	FdSlot* slot = _fds.find(fd);
+	if (slot && slot->kind == FD_CLIENT) {
+		return slot;
 	}
 	
 	// Create new client
-	Client* client = new Client(fd, address, port);
-	_clients[fd] = client;
+	slot = _fds.acquire(fd, FD_CLIENT);
+	slot->client = new Client(fd, address, port, _buffers);
+	++_clientCount;
 	
-	// Add to epoll - initially interested in read events
-	// Also add EPOLLRDHUP to detect peer close
-	_epoll.add(fd, EVENT_READ | EVENT_RDHUP);
+	_epoll.add(fd, events, slot);
 	
-	return client;
+	return slot;
 }
 
 // Remove a client
 void ClientManager::removeClient(int fd) {
-	std::map<int, Client*>::iterator it = _clients.find(fd);
-	if (it != _clients.end()) {
+	FdSlot* slot = _fds.find(fd);
+	if (slot && slot->kind == FD_CLIENT) {
 		_epoll.remove(fd);
-		delete it->second;
-		_clients.erase(it);
+		delete slot->client;
+		_fds.release(fd);
+		--_clientCount;
 	}
 }
 
 // Get a client by fd
 Client* ClientManager::getClient(int fd) {
-	std::map<int, Client*>::iterator it = _clients.find(fd);
-	if (it != _clients.end()) {
-		return it->second;
+	FdSlot* slot = _fds.find(fd);
+	if (slot && slot->kind == FD_CLIENT) {
+		return slot->client;
 	}
 	return NULL;
 }
 
 // Check if fd is a client
 bool ClientManager::hasClient(int fd) const {
-	return _clients.find(fd) != _clients.end();
+	const FdSlot* slot = _fds.find(fd);
+	return slot && slot->kind == FD_CLIENT;
 }
 
 // Get all client fds
 std::vector<int> ClientManager::getAllClientFds() const {
 	std::vector<int> fds;
-	fds.reserve(_clients.size());
+	fds.reserve(_clientCount);
 	
-	for (std::map<int, Client*>::const_iterator it = _clients.begin();
-	     it != _clients.end(); ++it) {
-		fds.push_back(it->first);
-	}
-	
-	return fds;
-}
-
-// Check and remove timed out clients
-void ClientManager::checkTimeouts(time_t timeout) {
-	std::vector<int> timedOut = getTimedOutClients(timeout);
-	
-	for (size_t i = 0; i < timedOut.size(); ++i) {
-		std::cout << "Client " << timedOut[i] << " timed out, closing connection" << std::endl;
-		removeClient(timedOut[i]);
-	}
-}
-
-// Get list of timed out client fds
-std::vector<int> ClientManager::getTimedOutClients(time_t timeout) const {
-	std::vector<int> timedOut;
-	
-	for (std::map<int, Client*>::const_iterator it = _clients.begin();
-	     it != _clients.end(); ++it) {
-		if (it->second->isTimedOut(timeout)) {
-			timedOut.push_back(it->first);
+	for (size_t i = 0; i < _fds.size(); ++i) {
+		const FdSlot* slot = _fds.find(static_cast<int>(i));
+		if (slot && slot->kind == FD_CLIENT) {
+			fds.push_back(slot->fd);
 		}
 	}
 	
-	return timedOut;
+	return fds;
 }
 
 // Get client count
 size_t ClientManager::getClientCount() const {
-	return _clients.size();
-}
\ No newline at end of file
+	return _clientCount;
+}
@@ -45,34 +45,58 @@ Epoll::~Epoll() {
 	}
 }
 
+// Remember what fd is registered with
+void Epoll::setInterest(int fd, uint32_t events, void* data) {
+	if (fd < 0) {
+		return;
+	}
+	if (static_cast<size_t>(fd) >= _interest.size()) {
+		_interest.resize(static_cast<size_t>(fd) + 1);
+	}
+	_interest[fd].events = events;
+	_interest[fd].data = data;
+}
+
 // Add fd to epoll
-void Epoll::add(int fd, uint32_t events) {
+void Epoll::add(int fd, uint32_t events, void* data) {
 	struct epoll_event ev;
 	ev.events = events;
-	ev.data.fd = fd;
+	ev.data.ptr = data;
 	
 	if (::epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
 		std::stringstream ss;
 		ss << "Failed to add fd " << fd << " to epoll";
 		throw EpollError(ss.str(), errno);
 	}
+	setInterest(fd, events, data);
 }
 
 // Modify events for fd
-void Epoll::modify(int fd, uint32_t events) {
+void Epoll::modify(int fd, uint32_t events, void* data) {
+	// Unchanged interest - skip the syscall
+	if (fd >= 0 && static_cast<size_t>(fd) < _interest.size() &&
+	    _interest[fd].events == events && _interest[fd].data == data) {
+		return;
+	}
+	
 	struct epoll_event ev;
 	ev.events = events;
-	ev.data.fd = fd;
+	ev.data.ptr = data;
 	
 	if (::epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0) {
 		std::stringstream ss;
 		ss << "Failed to modify fd " << fd << " in epoll";
 		throw EpollError(ss.str(), errno);
 	}
+	setInterest(fd, events, data);
 }
 
 // Remove fd from epoll
 void Epoll::remove(int fd) {
+	if (fd >= 0 && static_cast<size_t>(fd) < _interest.size()) {
+		_interest[fd] = Interest();
+	}
+	
 	// Note: In Linux 2.6.9+, the event parameter can be NULL for EPOLL_CTL_DEL
 	if (::epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL) < 0) {
 		// Don't throw if fd was already removed or closed
@@ -102,7 +126,7 @@ int Epoll::wait(std::vector<Event>& events, int timeout) {
 	
 	for (int i = 0; i < numEvents; ++i) {
 		Event ev;
-		ev.fd = _eventBuffer[i].data.fd;
+		ev.data = _eventBuffer[i].data.ptr;
 		ev.events = _eventBuffer[i].events;
 		events.push_back(ev);
 	}
@@ -0,0 +1,52 @@
+#include "FdTable.hpp"
+
+// Constructor
+FdTable::FdTable() {}
+
+// Destructor
+FdTable::~FdTable() {}
+
+// Claim the slot of fd (reset to kind), growing the table if needed
+FdSlot* FdTable::acquire(int fd, FdKind kind) {
+	if (fd < 0) {
+		return NULL;
+	}
+	if (static_cast<size_t>(fd) >= _slots.size()) {
+		_slots.resize(static_cast<size_t>(fd) + 1);
+	}
+	
+	FdSlot& slot = _slots[fd];
+	slot = FdSlot();
+	slot.fd = fd;
+	slot.kind = kind;
+	return &slot;
+}
+
+// Slot of fd, or NULL if it is not in use
+FdSlot* FdTable::find(int fd) {
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size()) {
+		return NULL;
+	}
+	FdSlot& slot = _slots[fd];
+	return slot.kind == FD_FREE ? NULL : &slot;
+}
+
+const FdSlot* FdTable::find(int fd) const {
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size()) {
+		return NULL;
+	}
+	const FdSlot& slot = _slots[fd];
+	return slot.kind == FD_FREE ? NULL : &slot;
+}
+
+// Free the slot of fd
+void FdTable::release(int fd) {
+	if (fd >= 0 && static_cast<size_t>(fd) < _slots.size()) {
+		_slots[fd] = FdSlot();
+	}
+}
+
+// Number of slots
+size_t FdTable::size() const {
+	return _slots.size();
+}
@@ -0,0 +1,113 @@
+#include "FileCache.hpp"
+#include <sys/stat.h>
+
+// Constructor
+FileCache::FileCache(size_t maxBytes, size_t maxEntrySize, time_t validSeconds)
+	: _bytes(0),
+	  _maxBytes(maxBytes),
+	  _maxEntrySize(maxEntrySize),
+	  _validSeconds(validSeconds) {}
+
+// Destructor
+FileCache::~FileCache() {
+	_entries.clear();
+	_lru.clear();
+}
+
+// Find prebuilt response
+const std::string* FileCache::find(const std::string& key) {
+	EntryMap::iterator it = _entries.find(key);
+	if (it == _entries.end()) {
+		return NULL;
+	}
+	
+	Entry& entry = it->second;
+	time_t now = std::time(NULL);
+	
+	// Revalidate against disk once the entry is older than the valid interval
+	if (now - entry.validated >= _validSeconds) {
+		struct stat st;
+		if (stat(entry.filePath.c_str(), &st) != 0 ||
+		    !S_ISREG(st.st_mode) ||
+		    st.st_ino != entry.inode ||
+		    st.st_size != entry.size ||
+		    st.st_mtime != entry.mtime) {
+			erase(it);
+			return NULL;
+		}
+		entry.validated = now;
+	}
+	
+	// Move to front of LRU list
+	_lru.splice(_lru.begin(), _lru, entry.lruPos);
+	
+	return &entry.response;
+}
+
+// Insert response
+const std::string* FileCache::insert(const std::string& key, const std::string& filePath,
+                                     const OpenFileInfo& info, std::string& response) {
+	EntryMap::iterator existing = _entries.find(key);
+	if (existing != _entries.end()) {
+		erase(existing);
+	}
+	
+	if (response.size() > _maxBytes) {
+		return NULL;
+	}
+	
+	// Evict least recently used entries until the response fits
+	while (!_lru.empty() && _bytes + response.size() > _maxBytes) {
+		erase(_entries.find(_lru.back()));
+	}
+	
+	_lru.push_front(key);
+	
+	Entry& entry = _entries[key];
+	entry.response.swap(response);
+	entry.filePath = filePath;
+	entry.size = info.size;
+	entry.mtime = info.mtime;
+	entry.inode = info.inode;
+	entry.validated = std::time(NULL);
+	entry.lruPos = _lru.begin();
+	_bytes += entry.response.size();
+	
+	return &entry.response;
+}
+
+// Drop every entry built from filePath
+void FileCache::remove(const std::string& filePath) {
+	EntryMap::iterator it = _entries.begin();
+	while (it != _entries.end()) {
+		EntryMap::iterator current = it++;
+		if (current->second.filePath == filePath) {
+			erase(current);
+		}
+	}
+}
+
+// Largest file body accepted
+size_t FileCache::getMaxEntrySize() const {
+	return _maxEntrySize;
+}
+
+size_t FileCache::getMaxBytes() const {
+	return _maxBytes;
+}
+
+// Stats
+size_t FileCache::size() const {
+	return _entries.size();
+}
+
+size_t FileCache::bytes() const {
+	return _bytes;
+}
+
+// Erase entry and release its bytes
+void FileCache::erase(EntryMap::iterator it) {
+	_bytes -= it->second.response.size();
+	_lru.erase(it->second.lruPos);
+	_entries.erase(it);
+}
@@ -1,7 +1,9 @@
 #include "FileServer.hpp"
+#include "Response.hpp"
 #include <fstream>
 #include <sstream>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <dirent.h>
 #include <unistd.h>
 #include <ctime>
@@ -16,7 +18,19 @@ FileServer::FileServer() {
 }
 
 // Destructor
-FileServer::~FileServer() {}
+FileServer::~FileServer() {
+	for (std::map<const ServerConfig*, OpenFileCache*>::iterator it = _openFileCaches.begin();
+	     it != _openFileCaches.end(); ++it) {
+		delete it->second;
+	}
+	_openFileCaches.clear();
+	
+	for (std::map<const ServerConfig*, FileCache*>::iterator it = _fileCaches.begin();
+	     it != _fileCaches.end(); ++it) {
+		delete it->second;
+	}
+	_fileCaches.clear();
+}
 
 // Initialize MIME types
 void FileServer::initMimeTypes() {
@@ -144,12 +158,38 @@ std::string FileServer::getLastModified(const std::string& path) const {
 		return "";
 	}
 	
+	return formatHttpDate(st.st_mtime);
+}
+
+// Format time as HTTP-date (RFC 7231 IMF-fixdate)
+std::string FileServer::formatHttpDate(time_t time) {
 	char buf[128];
-	struct tm* tm_info = gmtime(&st.st_mtime);
-	strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", tm_info);
+	struct tm tm_info;
+	gmtime_r(&time, &tm_info);
+	strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm_info);
 	return std::string(buf);
 }
 
+// Parse HTTP-date (IMF-fixdate, RFC 850 or asctime format)
+bool FileServer::parseHttpDate(const std::string& value, time_t& time) {
+	static const char* formats[] = {
+		"%a, %d %b %Y %H:%M:%S GMT",  // Sun, 06 Nov 1994 08:49:37 GMT
+		"%A, %d-%b-%y %H:%M:%S GMT",  // Sunday, 06-Nov-94 08:49:37 GMT
+		"%a %b %e %H:%M:%S %Y"        // Sun Nov  6 08:49:37 1994
+	};
+	
+	for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+		struct tm tm_info;
+		std::memset(&tm_info, 0, sizeof(tm_info));
+		const char* end = strptime(value.c_str(), formats[i], &tm_info);
+		if (end && *end == '\0') {
+			time = timegm(&tm_info);
+			return time != static_cast<time_t>(-1);
+		}
+	}
+	return false;
+}
+
 // Read file content
 bool FileServer::readFile(const std::string& path, std::string& content) const {
 	std::ifstream file(path.c_str(), std::ios::binary);
@@ -176,9 +216,420 @@ bool FileServer::readFile(const std::string& path, std::string& content) const {
 	return file.good() || file.eof();
 }
 
+// Collect file metadata and validators from stat() data
+void FileServer::describeFile(const std::string& path, const struct stat& st,
+                              OpenFileInfo& info) const {
+	info.size = st.st_size;
+	info.mtime = st.st_mtime;
+	info.inode = st.st_ino;
+	info.mimeType = getMimeType(path);
+	
+	// Validator: hex mtime-size-inode
+	std::stringstream etag;
+	etag << std::hex << "\"" << static_cast<unsigned long>(st.st_mtime)
+	     << "-" << static_cast<unsigned long long>(st.st_size)
+	     << "-" << static_cast<unsigned long long>(st.st_ino) << "\"";
+	info.etag = etag.str();
+	info.lastModified = formatHttpDate(st.st_mtime);
+}
+
+// Open file for streaming and collect its metadata (caller owns info.fd)
+bool FileServer::openFile(const std::string& path, OpenFileInfo& info) const {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+	
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return false;
+	}
+	
+	info.fd = fd;
+	describeFile(path, st, info);
+	
+	return true;
+}
+
+// Check whether an entity tag appears in an If-None-Match list (weak comparison)
+static bool etagListMatches(const std::string& list, const std::string& etag) {
+	std::string opaque = etag;
+	if (opaque.compare(0, 2, "W/") == 0) {
+		opaque.erase(0, 2);
+	}
+	
+	size_t pos = 0;
+	while (pos < list.size()) {
+		size_t comma = list.find(',', pos);
+		if (comma == std::string::npos) {
+			comma = list.size();
+		}
+		
+		// Trim whitespace around the list member
+		size_t start = list.find_first_not_of(" \t", pos);
+		size_t end = list.find_last_not_of(" \t", comma - 1);
+		if (start != std::string::npos && start < comma && end >= start) {
+			std::string candidate = list.substr(start, end - start + 1);
+			if (candidate == "*") {
+				return true;
+			}
+			if (candidate.compare(0, 2, "W/") == 0) {
+				candidate.erase(0, 2);
+			}
+			if (candidate == opaque) {
+				return true;
+			}
+		}
+		pos = comma + 1;
+	}
+	return false;
+}
+
+// Evaluate If-None-Match / If-Modified-Since against the file validators
+bool FileServer::isNotModified(const HttpRequest& request, const OpenFileInfo& info) const {
+	const std::string& method = request.getMethod();
+	if (method != "GET" && method != "HEAD") {
+		return false;
+	}
+	
+	// If-None-Match takes precedence over If-Modified-Since (RFC 7232 section 6)
+	const std::string& ifNoneMatch = request.getHeader(HEADER_IF_NONE_MATCH);
+	if (!ifNoneMatch.empty()) {
+		return etagListMatches(ifNoneMatch, info.etag);
+	}
+	
+	const std::string& ifModifiedSince = request.getHeader(HEADER_IF_MODIFIED_SINCE);
+	if (!ifModifiedSince.empty()) {
+		time_t since;
+		if (parseHttpDate(ifModifiedSince, since)) {
+			return info.mtime <= since;
+		}
+	}
+	return false;
+}
+
+// Build a 304 result carrying the validators
+FileResult FileServer::notModified(const OpenFileInfo& info) const {
+	FileResult result;
+	result.success = true;
+	result.statusCode = 304;
+	result.statusText = "Not Modified";
+	result.contentType = info.mimeType;
+	result.etag = info.etag;
+	result.lastModified = info.lastModified;
+	return result;
+}
+
+// Get (or lazily create) the open file cache of a server block
+OpenFileCache* FileServer::getOpenFileCache(const ServerConfig* server) {
+	if (!server || server->getOpenFileCache() == 0) {
+		return NULL;
+	}
+	
+	ScopedLock lock(_cacheMutex);
+	std::map<const ServerConfig*, OpenFileCache*>::iterator it = _openFileCaches.find(server);
+	if (it != _openFileCaches.end()) {
+		return it->second;
+	}
+	
+	OpenFileCache* cache = new OpenFileCache(server->getOpenFileCache(),
+	                                         server->getOpenFileCacheValid());
+	_openFileCaches[server] = cache;
+	return cache;
+}
+
+// Get (or lazily create) the in-memory response cache of a server block
+FileCache* FileServer::getFileCache(const ServerConfig* server) {
+	if (!server || server->getFileCacheSize() == 0) {
+		return NULL;
+	}
+	
+	ScopedLock lock(_cacheMutex);
+	std::map<const ServerConfig*, FileCache*>::iterator it = _fileCaches.find(server);
+	if (it != _fileCaches.end()) {
+		return it->second;
+	}
+	
+	FileCache* cache = new FileCache(server->getFileCacheSize(),
+	                                 server->getFileCacheMaxEntry(),
+	                                 server->getOpenFileCacheValid());
+	_fileCaches[server] = cache;
+	return cache;
+}
+
+// Only plain keep-alive GETs get the prebuilt response
+bool FileServer::isCacheableRequest(const HttpRequest& request) const {
+	return request.getMethod() == "GET" &&
+	       request.isKeepAlive() &&
+	       request.getHeader(HEADER_RANGE).empty() &&
+	       request.getHeader(HEADER_IF_RANGE).empty() &&
+	       request.getHeader(HEADER_IF_NONE_MATCH).empty() &&
+	       request.getHeader(HEADER_IF_MODIFIED_SINCE).empty();
+}
+
+// Copy a cached entry out under the lock; info.fd is a dup owned by the caller
+bool FileServer::lookupOpenFile(OpenFileCache* cache, const std::string& path, OpenFileInfo& info) {
+	ScopedLock lock(_cacheMutex);
+	
+	const OpenFileInfo* cached = cache->find(path);
+	if (!cached) {
+		return false;
+	}
+	
+	// The cache may close its fd on eviction - the caller streams from its own
+	info = *cached;
+	info.fd = fcntl(cached->fd, F_DUPFD_CLOEXEC, 0);  // Not inherited by CGIs
+	return info.fd >= 0;
+}
+
+// Store a dup of info.fd in the open file cache (caller keeps info.fd)
+void FileServer::storeOpenFile(OpenFileCache* cache, const std::string& path,
+                               const OpenFileInfo& info) {
+	OpenFileInfo entry = info;
+	entry.fd = fcntl(info.fd, F_DUPFD_CLOEXEC, 0);
+	if (entry.fd < 0) {
+		return;
+	}
+	
+	ScopedLock lock(_cacheMutex);
+	cache->insert(path, entry);
+}
+
+// Copy a prebuilt response out of the file cache
+bool FileServer::lookupResponse(FileCache* fileCache, const std::string& key,
+                                std::string& response) {
+	ScopedLock lock(_cacheMutex);
+	
+	const std::string* cached = fileCache->find(key);
+	if (!cached) {
+		return false;
+	}
+	response = *cached;
+	return true;
+}
+
+// Read a small file and store its complete response in the file cache
+bool FileServer::cacheResponse(FileCache* fileCache, const std::string& key,
+                               const std::string& filePath, const OpenFileInfo& info,
+                               std::string& response) {
+	std::string body(static_cast<size_t>(info.size), '\0');
+	size_t got = 0;
+	
+	// pread() leaves the offset of a shared descriptor untouched
+	while (got < body.size()) {
+		ssize_t n = pread(info.fd, &body[got], body.size() - got, static_cast<off_t>(got));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		got += static_cast<size_t>(n);
+	}
+	
+	Response built;
+	built.setContentType(info.mimeType);
+	built.setBody(body);
+	built.setKeepAlive(true);
+	built.setHeader("Server", "webserv/1.0");
+	built.setHeader("ETag", info.etag);
+	built.setHeader("Last-Modified", info.lastModified);
+	built.setHeader("Accept-Ranges", "bytes");
+	
+	// The cache swaps its copy in; the caller keeps the original. A response
+	// the cache turns down (headers push it over the budget) is still served.
+	response = built.build();
+	std::string entry = response;
+	
+	ScopedLock lock(_cacheMutex);
+	fileCache->insert(key, filePath, info, entry);
+	return true;
+}
+
+// Parse a non-negative decimal byte position
+static bool parseBytePos(const std::string& s, off_t& value) {
+	if (s.empty() || s.size() > 18) {
+		return false;
+	}
+	value = 0;
+	for (size_t i = 0; i < s.size(); ++i) {
+		if (s[i] < '0' || s[i] > '9') {
+			return false;
+		}
+		value = value * 10 + (s[i] - '0');
+	}
+	return true;
+}
+
+// Order ranges by offset for coalescing
+static bool rangeBefore(const ByteRange& a, const ByteRange& b) {
+	return a.offset < b.offset;
+}
+
+// Resolve Range / If-Range against the file: 200 (whole file), 206 or 416
+int FileServer::evaluateRange(const HttpRequest& request, const OpenFileInfo& info,
+                              std::vector<ByteRange>& ranges) const {
+	const std::string& range = request.getHeader(HEADER_RANGE);
+	if (range.empty() || request.getMethod() != "GET") {
+		return 200;
+	}
+	
+	// If-Range: only honour Range while the validator still matches (strong comparison)
+	const std::string& ifRange = request.getHeader(HEADER_IF_RANGE);
+	if (!ifRange.empty()) {
+		if (ifRange[0] == '"' || ifRange.compare(0, 2, "W/") == 0) {
+			if (ifRange != info.etag) {
+				return 200;
+			}
+		} else {
+			time_t date;
+			if (!parseHttpDate(ifRange, date) || date != info.mtime) {
+				return 200;
+			}
+		}
+	}
+	
+	// Unknown units are ignored (RFC 7233 section 3.1)
+	if (range.compare(0, 6, "bytes=") != 0) {
+		return 200;
+	}
+	
+	size_t pos = 6;
+	size_t specs = 0;
+	while (pos <= range.size()) {
+		size_t comma = range.find(',', pos);
+		if (comma == std::string::npos) {
+			comma = range.size();
+		}
+		
+		// Trim whitespace around the range spec
+		size_t start = range.find_first_not_of(" \t", pos);
+		size_t end = (comma > pos) ? range.find_last_not_of(" \t", comma - 1) : std::string::npos;
+		pos = comma + 1;
+		if (start == std::string::npos || start >= comma || end == std::string::npos || end < start) {
+			continue;  // Empty list element
+		}
+		
+		std::string spec = range.substr(start, end - start + 1);
+		size_t dash = spec.find('-');
+		if (dash == std::string::npos || ++specs > MAX_RANGES) {
+			ranges.clear();
+			return 200;
+		}
+		
+		off_t first;
+		off_t last;
+		if (dash == 0) {
+			// Suffix range: last N bytes
+			off_t suffix;
+			if (!parseBytePos(spec.substr(1), suffix)) {
+				ranges.clear();
+				return 200;
+			}
+			if (suffix == 0 || info.size == 0) {
+				continue;  // Unsatisfiable
+			}
+			first = (suffix < info.size) ? info.size - suffix : 0;
+			last = info.size - 1;
+		} else {
+			if (!parseBytePos(spec.substr(0, dash), first)) {
+				ranges.clear();
+				return 200;
+			}
+			if (dash + 1 == spec.size()) {
+				last = info.size - 1;
+			} else if (!parseBytePos(spec.substr(dash + 1), last) || last < first) {
+				ranges.clear();
+				return 200;
+			}
+			if (first >= info.size) {
+				continue;  // Unsatisfiable
+			}
+			if (last >= info.size) {
+				last = info.size - 1;
+			}
+		}
+		ranges.push_back(ByteRange(first, last - first + 1));
+	}
+	
+	if (specs == 0) {
+		return 200;
+	}
+	if (ranges.empty()) {
+		return 416;
+	}
+	
+	// Coalesce overlapping or adjacent ranges
+	if (ranges.size() > 1) {
+		std::sort(ranges.begin(), ranges.end(), rangeBefore);
+		std::vector<ByteRange> merged;
+		merged.push_back(ranges[0]);
+		for (size_t i = 1; i < ranges.size(); ++i) {
+			ByteRange& back = merged.back();
+			if (ranges[i].offset <= back.offset + back.length) {
+				off_t end = ranges[i].offset + ranges[i].length;
+				if (end > back.offset + back.length) {
+					back.length = end - back.offset;
+				}
+			} else {
+				merged.push_back(ranges[i]);
+			}
+		}
+		ranges.swap(merged);
+	}
+	return 206;
+}
+
+// Build a successful result for an open file
+FileResult FileServer::serveOpenFile(const HttpRequest& request, const OpenFileInfo& info,
+                                     FileCache* fileCache, const std::string& key,
+                                     const std::string& filePath) {
+	FileResult result;
+	
+	// Small file: answer from a prebuilt in-memory response (not read at all
+	// when the body alone is over the cache budget)
+	if (fileCache && info.size <= static_cast<off_t>(fileCache->getMaxEntrySize()) &&
+	    info.size < static_cast<off_t>(fileCache->getMaxBytes())) {
+		if (cacheResponse(fileCache, key, filePath, info, result.cachedResponse)) {
+			close(info.fd);
+			result.success = true;
+			result.statusCode = 200;
+			result.statusText = "OK";
+			result.contentType = info.mimeType;
+			result.etag = info.etag;
+			result.lastModified = info.lastModified;
+			return result;
+		}
+	}
+	
+	int status = evaluateRange(request, info, result.ranges);
+	if (status == 416) {
+		close(info.fd);
+		result.statusCode = 416;
+		result.statusText = "Range Not Satisfiable";
+		result.errorMessage = "Requested range not satisfiable";
+		result.body = generateErrorPage(416, result.errorMessage);
+		result.fileSize = info.size;
+		return result;
+	}
+	
+	result.fileFd = info.fd;
+	result.success = true;
+	result.statusCode = status;
+	result.statusText = (status == 206) ? "Partial Content" : "OK";
+	result.contentType = info.mimeType;
+	result.fileSize = info.size;
+	result.etag = info.etag;
+	result.lastModified = info.lastModified;
+	
+	return result;
+}
+
 // Find index file in directory
 std::string FileServer::findIndexFile(const std::string& dirPath, 
-                                       const std::vector<std::string>& indexFiles) const {
+                                       const std::vector<std::string>& indexFiles,
+                                       OpenFileCache* cache) {
 	for (size_t i = 0; i < indexFiles.size(); ++i) {
 		std::string indexPath = dirPath;
 		if (!indexPath.empty() && indexPath[indexPath.size() - 1] != '/') {
@@ -186,7 +637,15 @@ std::string FileServer::findIndexFile(const std::string& dirPath,
 		}
 		indexPath += indexFiles[i];
 		
-		if (fileExists(indexPath) && !isDirectory(indexPath)) {
+		if (cache) {
+			ScopedLock lock(_cacheMutex);
+			if (cache->find(indexPath)) {
+				return indexPath;
+			}
+		}
+		
+		struct stat st;
+		if (stat(indexPath.c_str(), &st) == 0 && !S_ISDIR(st.st_mode)) {
 			return indexPath;
 		}
 	}
@@ -206,8 +665,38 @@ FileResult FileServer::serveFile(const HttpRequest& request, const RouteResult&
 	}
 	
 	std::string filePath = route.resolvedPath;
-	// Check if path exists
-	if (!fileExists(filePath)) {
+	OpenFileCache* cache = getOpenFileCache(route.server);
+	FileCache* fileCache = isCacheableRequest(request) ? getFileCache(route.server) : NULL;
+	
+	// A location's own path resolves to the same directory key with and without
+	// its trailing slash; only the slashed form may get the index page cached
+	// there (the other is redirected below)
+	const std::string& path = request.getPath();
+	bool directoryKey = !filePath.empty() && filePath[filePath.size() - 1] == '/';
+	bool slashedPath = !path.empty() && path[path.size() - 1] == '/';
+	
+	// Hottest path: complete response already in memory
+	if (fileCache && (slashedPath || !directoryKey) &&
+	    lookupResponse(fileCache, route.resolvedPath, result.cachedResponse)) {
+		result.success = true;
+		result.statusCode = 200;
+		result.statusText = "OK";
+		return result;
+	}
+	
+	// Hot path: file already open and recently validated
+	OpenFileInfo info;
+	if (cache && lookupOpenFile(cache, filePath, info)) {
+		if (isNotModified(request, info)) {
+			close(info.fd);
+			return notModified(info);
+		}
+		return serveOpenFile(request, info, fileCache, route.resolvedPath, filePath);
+	}
+	
+	// One stat() covers existence, type and permissions
+	struct stat st;
+	if (stat(filePath.c_str(), &st) != 0) {
 		result.statusCode = 404;
 		result.statusText = "Not Found";
 		result.errorMessage = "File not found: " + request.getPath();
@@ -216,7 +705,7 @@ FileResult FileServer::serveFile(const HttpRequest& request, const RouteResult&
 	}
 	
 	// Handle directory
-	if (isDirectory(filePath)) {
+	if (S_ISDIR(st.st_mode)) {
 		result.isDirectory = true;
 		
 		// Check if URI ends with slash
@@ -231,11 +720,25 @@ FileResult FileServer::serveFile(const HttpRequest& request, const RouteResult&
 		
 		// Try to find index file
 		const std::vector<std::string>& indexFiles = route.location->getIndex();
-		std::string indexPath = findIndexFile(filePath, indexFiles);
+		std::string indexPath = findIndexFile(filePath, indexFiles, cache);
 		
 		if (!indexPath.empty()) {
 			// Serve index file
 			filePath = indexPath;
+			if (cache && lookupOpenFile(cache, filePath, info)) {
+				if (isNotModified(request, info)) {
+					close(info.fd);
+					return notModified(info);
+				}
+				return serveOpenFile(request, info, fileCache, route.resolvedPath, filePath);
+			}
+			if (stat(filePath.c_str(), &st) != 0) {
+				result.statusCode = 404;
+				result.statusText = "Not Found";
+				result.errorMessage = "File not found: " + request.getPath();
+				result.body = generateErrorPage(404, result.errorMessage);
+				return result;
+			}
 		} else if (route.location->getAutoIndex()) {
 			// Generate directory listing
 			return generateDirectoryListing(filePath, uri);
@@ -250,7 +753,7 @@ FileResult FileServer::serveFile(const HttpRequest& request, const RouteResult&
 	}
 	
 	// Check if file is readable
-	if (!isReadable(filePath)) {
+	if (!(st.st_mode & (S_IRUSR | S_IRGRP | S_IROTH))) {
 		result.statusCode = 403;
 		result.statusText = "Forbidden";
 		result.errorMessage = "Permission denied";
@@ -258,19 +761,16 @@ FileResult FileServer::serveFile(const HttpRequest& request, const RouteResult&
 		return result;
 	}
 	
-	// Check file size
-	size_t fileSize = getFileSize(filePath);
-	if (fileSize > MAX_FILE_SIZE) {
-		result.statusCode = 413;
-		result.statusText = "Payload Too Large";
-		result.errorMessage = "File too large to serve";
-		result.body = generateErrorPage(413, result.errorMessage);
-		return result;
+	// Validators come from stat() alone, so a 304 never opens the file
+	if (S_ISREG(st.st_mode)) {
+		describeFile(filePath, st, info);
+		if (isNotModified(request, info)) {
+			return notModified(info);
+		}
 	}
 	
-	// Read file
-	std::string content;
-	if (!readFile(filePath, content)) {
+	// Open file - the body is streamed from the fd by the client
+	if (!openFile(filePath, info)) {
 		result.statusCode = 500;
 		result.statusText = "Internal Server Error";
 		result.errorMessage = "Failed to read file";
@@ -278,14 +778,10 @@ FileResult FileServer::serveFile(const HttpRequest& request, const RouteResult&
 		return result;
 	}
 	
-	// Success!
-	result.success = true;
-	result.statusCode = 200;
-	result.statusText = "OK";
-	result.contentType = getMimeType(filePath);
-	result.body = content;
-	
-	return result;
+	if (cache) {
+		storeOpenFile(cache, filePath, info);
+	}
+	return serveOpenFile(request, info, fileCache, route.resolvedPath, filePath);
 }
 
 // Serve a specific file path (for error pages, etc.)
@@ -527,8 +1023,9 @@ std::string FileServer::formatSize(size_t size) const {
 // Format time
 std::string FileServer::formatTime(time_t time) const {
 	char buf[64];
-	struct tm* tm_info = localtime(&time);
-	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M", tm_info);
+	struct tm tm_info;
+	localtime_r(&time, &tm_info);
+	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M", &tm_info);
 	return std::string(buf);
 }
 
@@ -538,6 +1035,7 @@ std::string FileServer::getStatusText(int code) const {
 		case 200: return "OK";
 		case 201: return "Created";
 		case 204: return "No Content";
+		case 206: return "Partial Content";
 		case 301: return "Moved Permanently";
 		case 302: return "Found";
 		case 303: return "See Other";
@@ -556,6 +1054,7 @@ std::string FileServer::getStatusText(int code) const {
 		case 413: return "Payload Too Large";
 		case 414: return "URI Too Long";
 		case 415: return "Unsupported Media Type";
+		case 416: return "Range Not Satisfiable";
 		case 429: return "Too Many Requests";
 		case 500: return "Internal Server Error";
 		case 501: return "Not Implemented";
@@ -679,6 +1178,19 @@ FileResult FileServer::deleteFile(const HttpRequest& request, const RouteResult&
 		}
 	}
 	
+	// Drop any cached descriptor for the file
+	OpenFileCache* cache = getOpenFileCache(route.server);
+	FileCache* fileCache = getFileCache(route.server);
+	if (cache || fileCache) {
+		ScopedLock lock(_cacheMutex);
+		if (cache) {
+			cache->remove(filePath);
+		}
+		if (fileCache) {
+			fileCache->remove(filePath);
+		}
+	}
+	
 	// Attempt to delete the file
 	if (unlink(filePath.c_str()) != 0) {
 		// Deletion failed
@@ -1,26 +1,129 @@
 #include "HttpRequest.hpp"
+#include "HttpScan.hpp"
 #include <sstream>
 #include <cctype>
 #include <cstdlib>
 #include <algorithm>
 #include <iostream>
 #include <cstddef>
+#include <cstring>
+#include <strings.h>
+
+// Lowercase names of the known headers, in HttpHeader order
+static const char* const HEADER_NAMES[HEADER_COUNT] = {
+	"accept",
+	"accept-charset",
+	"accept-encoding",
+	"accept-language",
+	"authorization",
+	"cache-control",
+	"connection",
+	"content-disposition",
+	"content-encoding",
+	"content-length",
+	"content-type",
+	"cookie",
+	"dnt",
+	"expect",
+	"forwarded",
+	"host",
+	"if-match",
+	"if-modified-since",
+	"if-none-match",
+	"if-range",
+	"if-unmodified-since",
+	"keep-alive",
+	"origin",
+	"pragma",
+	"priority",
+	"range",
+	"referer",
+	"sec-fetch-dest",
+	"sec-fetch-mode",
+	"sec-fetch-site",
+	"sec-fetch-user",
+	"te",
+	"transfer-encoding",
+	"upgrade",
+	"upgrade-insecure-requests",
+	"user-agent",
+	"x-filename",
+	"x-forwarded-for",
+	"x-requested-with"
+};
+
+// Hash table from header name to HttpHeader, keyed on length and the
+// (lowercased) first and last characters; built once before main()
+class HeaderIndex {
+public:
+	HeaderIndex() {
+		for (size_t i = 0; i < BUCKETS; ++i) {
+			_buckets[i] = HEADER_UNKNOWN;
+		}
+		for (int h = 0; h < HEADER_COUNT; ++h) {
+			const char* name = HEADER_NAMES[h];
+			size_t length = std::strlen(name);
+			size_t i = hash(name, length);
+			while (_buckets[i] != HEADER_UNKNOWN) {
+				i = (i + 1) % BUCKETS;
+			}
+			_buckets[i] = static_cast<HttpHeader>(h);
+		}
+	}
+	
+	HttpHeader find(const char* name, size_t length) const {
+		if (length == 0) {
+			return HEADER_UNKNOWN;
+		}
+		for (size_t i = hash(name, length); _buckets[i] != HEADER_UNKNOWN; i = (i + 1) % BUCKETS) {
+			const char* candidate = HEADER_NAMES[_buckets[i]];
+			if (std::strlen(candidate) == length && strncasecmp(candidate, name, length) == 0) {
+				return _buckets[i];
+			}
+		}
+		return HEADER_UNKNOWN;
+	}
+
+private:
+	static const size_t BUCKETS = 128;  // Power of two, at least 2x HEADER_COUNT
+	
+	static size_t hash(const char* name, size_t length) {
+		size_t first = static_cast<unsigned char>(name[0]) | 0x20;
+		size_t last = static_cast<unsigned char>(name[length - 1]) | 0x20;
+		return (length * 31 + first * 7 + last) & (BUCKETS - 1);
+	}
+	
+	HttpHeader _buckets[BUCKETS];
+};
+
+static const HeaderIndex g_headerIndex;
 
 // Constructor
-HttpRequest::HttpRequest()
+HttpRequest::HttpRequest(Arena& arena)
 	: _method(""),
 	  _uri(""),
 	  _path(""),
 	  _queryString(""),
 	  _httpVersion(""),
+	  _otherHeaders(),
+	  _arena(arena),
+	  _headerCount(0),
 	  _body(""),
+	  _bodySink(NULL),
+	  _bodySize(0),
 	  _contentLength(0),
 	  _chunked(false),
 	  _currentChunkSize(0),
 	  _currentChunkRead(0),
 	  _state(PARSE_REQUEST_LINE),
+	  _scanOffset(0),
 	  _errorMessage(""),
-	  _maxBodySize(1024 * 1024 * 1024) {}  // 1 GB default
+	  _errorStatus(400),
+	  _maxBodySize(DEFAULT_MAX_BODY_SIZE) {
+	for (int h = 0; h < HEADER_COUNT; ++h) {
+		_hasKnownHeader[h] = false;
+	}
+}
 
 // Destructor
 HttpRequest::~HttpRequest() {}
@@ -32,38 +135,72 @@ void HttpRequest::reset() {
 	_path.clear();
 	_queryString.clear();
 	_httpVersion.clear();
-	_headers.clear();
+	for (int h = 0; h < HEADER_COUNT; ++h) {
+		if (_hasKnownHeader[h]) {
+			_knownHeaders[h].clear();  // Keeps the capacity for the next request
+			_hasKnownHeader[h] = false;
+		}
+	}
+	_otherHeaders.clear();
+	_headerCount = 0;
 	_body.clear();
+	_bodySink = NULL;
+	_bodySize = 0;
 	_contentLength = 0;
 	_chunked = false;
 	_currentChunkSize = 0;
 	_currentChunkRead = 0;
 	_state = PARSE_REQUEST_LINE;
+	_scanOffset = 0;
 	_errorMessage.clear();
+	_errorStatus = 400;
+	_maxBodySize = DEFAULT_MAX_BODY_SIZE;
 }
 
 // Helper: convert string to lowercase
 std::string HttpRequest::toLower(const std::string& str) {
 	std::string result = str;
-	for (size_t i = 0; i < result.size(); ++i) {
-		result[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(result[i])));
+	if (!result.empty()) {
+		HttpScan::toLower(&result[0], result.size());
 	}
 	return result;
 }
 
+// Find the CRLF ending the line that starts at pos. Resumes the scan where
+// the previous call stopped, so a line trickling in is only scanned once.
+bool HttpRequest::findLineEnd(const char* data, size_t size, size_t pos, size_t& lineEnd) {
+	size_t from = pos + _scanOffset;
+	
+	while (from < size) {
+		const char* newline = HttpScan::findNewline(data + from, data + size);
+		if (!newline) {
+			break;
+		}
+		size_t at = static_cast<size_t>(newline - data);
+		if (at > pos && data[at - 1] == '\r') {
+			lineEnd = at - 1;
+			_scanOffset = 0;
+			return true;
+		}
+		from = at + 1;
+	}
+	
+	_scanOffset = size - pos;
+	return false;
+}
+
 // Main parsing method
-HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsumed) {
+HttpParseResult HttpRequest::parse(const char* data, size_t size, size_t& bytesConsumed) {
 	bytesConsumed = 0;
 	size_t pos = 0;
 	
-	while (pos < data.size() && _state != PARSE_COMPLETE && _state != PARSE_ERROR) {
+	while (pos < size && _state != PARSE_COMPLETE && _state != PARSE_ERROR) {
 		switch (_state) {
 			case PARSE_REQUEST_LINE: {
-				// Look for \r\n
-				size_t lineEnd = data.find("\r\n", pos);
-				if (lineEnd == std::string::npos) {
+				size_t lineEnd;
+				if (!findLineEnd(data, size, pos, lineEnd)) {
 					// Check if line is too long
-					if (data.size() - pos > MAX_REQUEST_LINE) {
+					if (size - pos > MAX_REQUEST_LINE) {
 						_state = PARSE_ERROR;
 						_errorMessage = "Request line too long";
 						return PARSE_FAILED;
@@ -72,8 +209,7 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 					return PARSE_INCOMPLETE;
 				}
 				
-				std::string line = data.substr(pos, lineEnd - pos);
-				if (!parseRequestLine(line)) {
+				if (!parseRequestLine(data + pos, lineEnd - pos)) {
 					return PARSE_FAILED;
 				}
 				
@@ -83,10 +219,9 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 			}
 			
 			case PARSE_HEADERS: {
-				// Look for \r\n
-				size_t lineEnd = data.find("\r\n", pos);
-				if (lineEnd == std::string::npos) {
-					if (data.size() - pos > MAX_HEADER_SIZE) {
+				size_t lineEnd;
+				if (!findLineEnd(data, size, pos, lineEnd)) {
+					if (size - pos > MAX_HEADER_SIZE) {
 						_state = PARSE_ERROR;
 						_errorMessage = "Header line too long";
 						return PARSE_FAILED;
@@ -95,34 +230,34 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 					return PARSE_INCOMPLETE;
 				}
 				
-				std::string line = data.substr(pos, lineEnd - pos);
+				const char* line = data + pos;
+				size_t lineLength = lineEnd - pos;
 				pos = lineEnd + 2;  // Skip \r\n
 				
 				// Empty line = end of headers
-				if (line.empty()) {
+				if (lineLength == 0) {
 					// Determine if there's a body
-					std::string transferEncoding = getHeader("transfer-encoding");
-					if (toLower(transferEncoding) == "chunked") {
+					const std::string& transferEncoding = _knownHeaders[HEADER_TRANSFER_ENCODING];
+					if (strcasecmp(transferEncoding.c_str(), "chunked") == 0) {
 						_chunked = true;
 						_state = PARSE_CHUNKED_SIZE;
 					} else if (_contentLength > 0) {
-						// std::size_t max_size = static_cast<std::size_t>(-1);
-						// if (_contentLength > _maxBodySize || _contentLength > max_size) {
-						// 	_state = PARSE_ERROR;
-						// 	_errorMessage = "Content-Length exceeds maximum body size";
-						// 	return PARSE_FAILED;
-						// }
 						_state = PARSE_BODY;
 					} else {
 						_state = PARSE_COMPLETE;
+						break;
 					}
+					
+					// Let the caller pick where the body goes
+					bytesConsumed = pos;
+					return PARSE_HEADERS_DONE;
 				} else {
-					if (!parseHeader(line)) {
+					if (!parseHeader(line, lineLength)) {
 						return PARSE_FAILED;
 					}
 					
 					// Check header count limit
-					if (_headers.size() > MAX_HEADERS_COUNT) {
+					if (_headerCount > MAX_HEADERS_COUNT) {
 						_state = PARSE_ERROR;
 						_errorMessage = "Too many headers";
 						return PARSE_FAILED;
@@ -132,14 +267,14 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 			}
 			
 			case PARSE_BODY: {
-				size_t remaining = _contentLength - _body.size();
-				size_t available = data.size() - pos;
+				size_t remaining = _contentLength - _bodySize;
+				size_t available = size - pos;
 				size_t toRead = (available < remaining) ? available : remaining;
 				
-				_body.append(data.substr(pos, toRead));
+				appendBody(data + pos, toRead);
 				pos += toRead;
 				
-				if (_body.size() >= _contentLength) {
+				if (_bodySize >= _contentLength) {
 					_state = PARSE_COMPLETE;
 				} else {
 					bytesConsumed = pos;
@@ -149,17 +284,30 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 			}
 			
 			case PARSE_CHUNKED_SIZE: {
-				// Look for \r\n
-				size_t lineEnd = data.find("\r\n", pos);
-				if (lineEnd == std::string::npos) {
+				size_t lineEnd;
+				if (!findLineEnd(data, size, pos, lineEnd)) {
+					if (size - pos > MAX_HEADER_SIZE) {
+						_state = PARSE_ERROR;
+						_errorMessage = "Chunk size line too long";
+						return PARSE_FAILED;
+					}
 					bytesConsumed = pos;
 					return PARSE_INCOMPLETE;
 				}
 				
-				std::string line = data.substr(pos, lineEnd - pos);
+				const char* line = data + pos;
+				size_t lineLength = lineEnd - pos;
 				pos = lineEnd + 2;
 				
-				if (!parseChunkedSize(line)) {
+				if (!parseChunkedSize(line, lineLength)) {
+					return PARSE_FAILED;
+				}
+				
+				// Check body size limit before any of the chunk is passed on
+				if (_currentChunkSize > _maxBodySize - _bodySize) {
+					_state = PARSE_ERROR;
+					_errorMessage = "Body exceeds maximum size";
+					_errorStatus = 413;
 					return PARSE_FAILED;
 				}
 				
@@ -173,53 +321,53 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 			}
 			
 			case PARSE_CHUNKED_DATA: {
+				// Pass on what is here of the chunk, in place
 				size_t remaining = _currentChunkSize - _currentChunkRead;
-				size_t available = data.size() - pos;
+				size_t available = size - pos;
 				size_t toRead = (available < remaining) ? available : remaining;
 				
-				_body.append(data.substr(pos, toRead));
+				appendBody(data + pos, toRead);
 				_currentChunkRead += toRead;
 				pos += toRead;
 				
-				// Check body size limit
-				if (_body.size() > _maxBodySize) {
-					_state = PARSE_ERROR;
-					_errorMessage = "Body exceeds maximum size";
-					return PARSE_FAILED;
-				}
-				
 				if (_currentChunkRead >= _currentChunkSize) {
-					// Need to read trailing \r\n after chunk data
-					if (pos + 2 > data.size()) {
-						bytesConsumed = pos;
-						return PARSE_INCOMPLETE;
-					}
-					if (data.substr(pos, 2) != "\r\n") {
-						_state = PARSE_ERROR;
-						_errorMessage = "Invalid chunk terminator";
-						return PARSE_FAILED;
-					}
-					pos += 2;
-					_state = PARSE_CHUNKED_SIZE;
-				} else {
+					_state = PARSE_CHUNKED_DATA_END;
+				}
+				break;
+			}
+			
+			case PARSE_CHUNKED_DATA_END: {
+				if (size - pos < 2) {
 					bytesConsumed = pos;
 					return PARSE_INCOMPLETE;
 				}
+				if (data[pos] != '\r' || data[pos + 1] != '\n') {
+					_state = PARSE_ERROR;
+					_errorMessage = "Invalid chunk terminator";
+					return PARSE_FAILED;
+				}
+				pos += 2;
+				_state = PARSE_CHUNKED_SIZE;
 				break;
 			}
 			
 			case PARSE_CHUNKED_TRAILER: {
 				// Look for empty line (end of trailers)
-				size_t lineEnd = data.find("\r\n", pos);
-				if (lineEnd == std::string::npos) {
+				size_t lineEnd;
+				if (!findLineEnd(data, size, pos, lineEnd)) {
+					if (size - pos > MAX_HEADER_SIZE) {
+						_state = PARSE_ERROR;
+						_errorMessage = "Trailer line too long";
+						return PARSE_FAILED;
+					}
 					bytesConsumed = pos;
 					return PARSE_INCOMPLETE;
 				}
 				
-				std::string line = data.substr(pos, lineEnd - pos);
+				bool emptyLine = (lineEnd == pos);
 				pos = lineEnd + 2;
 				
-				if (line.empty()) {
+				if (emptyLine) {
 					_state = PARSE_COMPLETE;
 				}
 				// Ignore trailer headers for now
@@ -242,17 +390,37 @@ HttpParseResult HttpRequest::parse(const std::string& data, size_t& bytesConsume
 	return PARSE_INCOMPLETE;
 }
 
+// Body bytes go to the sink if one is attached
+void HttpRequest::appendBody(const char* data, size_t size) {
+	if (_bodySink) {
+		_bodySink->write(data, size);
+	} else {
+		_body.append(data, size);
+	}
+	_bodySize += size;
+}
+
+// Body bytes that bypassed parse()
+void HttpRequest::addSplicedBody(size_t size) {
+	_bodySize += size;
+	if (_state == PARSE_BODY && _bodySize >= _contentLength) {
+		_state = PARSE_COMPLETE;
+	}
+}
+
 // Parse request line: METHOD URI HTTP/VERSION
-bool HttpRequest::parseRequestLine(const std::string& line) {
+bool HttpRequest::parseRequestLine(const char* line, size_t length) {
+	const char* lineEnd = line + length;
+	
 	// Find first space (after method)
-	size_t firstSpace = line.find(' ');
-	if (firstSpace == std::string::npos) {
+	const char* firstSpace = static_cast<const char*>(std::memchr(line, ' ', length));
+	if (!firstSpace) {
 		_state = PARSE_ERROR;
 		_errorMessage = "Invalid request line: missing method";
 		return false;
 	}
 	
-	_method = line.substr(0, firstSpace);
+	_method.assign(line, firstSpace);
 	
 	// Validate method
 	if (_method != "GET" && _method != "POST" && _method != "DELETE") {
@@ -262,14 +430,16 @@ bool HttpRequest::parseRequestLine(const std::string& line) {
 	}
 	
 	// Find second space (after URI)
-	size_t secondSpace = line.find(' ', firstSpace + 1);
-	if (secondSpace == std::string::npos) {
+	const char* uriStart = firstSpace + 1;
+	const char* secondSpace = static_cast<const char*>(
+		std::memchr(uriStart, ' ', static_cast<size_t>(lineEnd - uriStart)));
+	if (!secondSpace) {
 		_state = PARSE_ERROR;
 		_errorMessage = "Invalid request line: missing HTTP version";
 		return false;
 	}
 	
-	_uri = line.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+	_uri.assign(uriStart, secondSpace);
 	if (_uri.empty()) {
 		_state = PARSE_ERROR;
 		_errorMessage = "Invalid request line: empty URI";
@@ -279,7 +449,7 @@ bool HttpRequest::parseRequestLine(const std::string& line) {
 	// Parse URI into path and query string
 	parseUri();
 	
-	_httpVersion = line.substr(secondSpace + 1);
+	_httpVersion.assign(secondSpace + 1, lineEnd);
 	
 	// Validate HTTP version
 	if (_httpVersion != "HTTP/1.0" && _httpVersion != "HTTP/1.1") {
@@ -292,33 +462,60 @@ bool HttpRequest::parseRequestLine(const std::string& line) {
 }
 
 // Parse header line: Name: Value
-bool HttpRequest::parseHeader(const std::string& line) {
-	size_t colonPos = line.find(':');
-	if (colonPos == std::string::npos) {
+bool HttpRequest::parseHeader(const char* line, size_t length) {
+	// Header name must be a token directly followed by the colon
+	size_t nameLength = HttpScan::tokenLength(line, length);
+	if (nameLength == length) {
 		_state = PARSE_ERROR;
 		_errorMessage = "Invalid header: missing colon";
 		return false;
 	}
-	
-	std::string name = line.substr(0, colonPos);
-	std::string value = line.substr(colonPos + 1);
+	if (nameLength == 0 || line[nameLength] != ':') {
+		_state = PARSE_ERROR;
+		_errorMessage = "Invalid header name";
+		return false;
+	}
+	const char* colon = line + nameLength;
 	
 	// Trim leading/trailing whitespace from value
-	size_t valueStart = value.find_first_not_of(" \t");
-	if (valueStart != std::string::npos) {
-		value = value.substr(valueStart);
+	const char* valueStart = colon + 1;
+	const char* valueEnd = line + length;
+	while (valueStart < valueEnd && (*valueStart == ' ' || *valueStart == '\t')) {
+		++valueStart;
 	}
-	size_t valueEnd = value.find_last_not_of(" \t");
-	if (valueEnd != std::string::npos) {
-		value = value.substr(0, valueEnd + 1);
+	while (valueEnd > valueStart && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+		--valueEnd;
 	}
 	
-	// Store with lowercase name for case-insensitive lookup
-	std::string lowerName = toLower(name);
-	_headers[lowerName] = value;
+	// Known headers go to their slot, others to the arena with a lowercase name
+	HttpHeader header = findHeader(line, nameLength);
+	if (header == HEADER_UNKNOWN) {
+		HeaderField* field = const_cast<HeaderField*>(findOtherHeader(line, nameLength));
+		if (!field) {
+			char* name = _arena.copy(line, nameLength);
+			HttpScan::toLower(name, nameLength);
+			
+			HeaderField added;
+			added.name = name;
+			added.nameLength = nameLength;
+			_otherHeaders.push_back(added);
+			field = &_otherHeaders.back();
+			++_headerCount;
+		}
+		field->valueLength = static_cast<size_t>(valueEnd - valueStart);
+		field->value = _arena.copy(valueStart, field->valueLength);
+		return true;
+	}
+	
+	if (!_hasKnownHeader[header]) {
+		_hasKnownHeader[header] = true;
+		++_headerCount;
+	}
+	std::string& value = _knownHeaders[header];
+	value.assign(valueStart, valueEnd);
 	
 	// Handle Content-Length specially
-	if (lowerName == "content-length") {
+	if (header == HEADER_CONTENT_LENGTH) {
 		char* end = NULL;
 		long len = std::strtol(value.c_str(), &end, 10);
 		if (end == value.c_str() || *end != '\0' || len < 0) {
@@ -332,35 +529,39 @@ bool HttpRequest::parseHeader(const std::string& line) {
 	return true;
 }
 
-// Parse chunked size line
-bool HttpRequest::parseChunkedSize(const std::string& line) {
-	// Size is hex, optionally followed by extension (;...)
-	std::string sizeStr = line;
-	size_t semiPos = line.find(';');
-	if (semiPos != std::string::npos) {
-		sizeStr = line.substr(0, semiPos);
-	}
+// Parse chunked size line: hex size, optionally followed by extension (;...)
+bool HttpRequest::parseChunkedSize(const char* line, size_t length) {
+	const char* p = line;
+	const char* end = line + length;
 	
-	// Trim whitespace
-	size_t start = sizeStr.find_first_not_of(" \t");
-	if (start != std::string::npos) {
-		sizeStr = sizeStr.substr(start);
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
 	}
-	size_t end = sizeStr.find_last_not_of(" \t");
-	if (end != std::string::npos) {
-		sizeStr = sizeStr.substr(0, end + 1);
+	
+	size_t size = 0;
+	const char* digits = p;
+	for (; p < end && std::isxdigit(static_cast<unsigned char>(*p)); ++p) {
+		if (size > (static_cast<size_t>(-1) >> 4)) {
+			digits = p;  // Overflow
+			break;
+		}
+		int digit = std::isdigit(static_cast<unsigned char>(*p))
+			? *p - '0'
+			: std::tolower(static_cast<unsigned char>(*p)) - 'a' + 10;
+		size = (size << 4) | static_cast<size_t>(digit);
 	}
 	
-	char* endPtr = NULL;
-	unsigned long size = std::strtoul(sizeStr.c_str(), &endPtr, 16);
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
+	}
 	
-	if (endPtr == sizeStr.c_str() || (*endPtr != '\0' && *endPtr != ' ' && *endPtr != '\t')) {
+	if (p == digits || (p < end && *p != ';')) {
 		_state = PARSE_ERROR;
 		_errorMessage = "Invalid chunk size";
 		return false;
 	}
 	
-	_currentChunkSize = static_cast<size_t>(size);
+	_currentChunkSize = size;
 	return true;
 }
 
@@ -400,23 +601,57 @@ const std::string& HttpRequest::getHttpVersion() const {
 	return _httpVersion;
 }
 
-// Getters - Headers
+// Getters - Known headers
+const std::string& HttpRequest::getHeader(HttpHeader header) const {
+	return _knownHeaders[header];
+}
+
+bool HttpRequest::hasHeader(HttpHeader header) const {
+	return _hasKnownHeader[header];
+}
+
+// Getters - Any header by name
 std::string HttpRequest::getHeader(const std::string& name) const {
-	std::string lowerName = toLower(name);
-	std::map<std::string, std::string>::const_iterator it = _headers.find(lowerName);
-	if (it != _headers.end()) {
-		return it->second;
+	HttpHeader header = findHeader(name.c_str(), name.size());
+	if (header != HEADER_UNKNOWN) {
+		return _knownHeaders[header];
 	}
-	return "";
+	
+	const HeaderField* field = findOtherHeader(name.c_str(), name.size());
+	return field ? std::string(field->value, field->valueLength) : std::string();
 }
 
-const std::map<std::string, std::string>& HttpRequest::getHeaders() const {
-	return _headers;
+bool HttpRequest::hasHeader(const std::string& name) const {
+	HttpHeader header = findHeader(name.c_str(), name.size());
+	if (header != HEADER_UNKNOWN) {
+		return _hasKnownHeader[header];
+	}
+	
+	return findOtherHeader(name.c_str(), name.size()) != NULL;
 }
 
-bool HttpRequest::hasHeader(const std::string& name) const {
-	std::string lowerName = toLower(name);
-	return _headers.find(lowerName) != _headers.end();
+// Find a header outside the known set (case-insensitive)
+const HeaderField* HttpRequest::findOtherHeader(const char* name, size_t length) const {
+	for (size_t i = 0; i < _otherHeaders.size(); ++i) {
+		const HeaderField& field = _otherHeaders[i];
+		if (field.nameLength == length && strncasecmp(field.name, name, length) == 0) {
+			return &field;
+		}
+	}
+	return NULL;
+}
+
+const HttpRequest::HeaderList& HttpRequest::getOtherHeaders() const {
+	return _otherHeaders;
+}
+
+// Header name <-> HttpHeader
+const char* HttpRequest::headerName(HttpHeader header) {
+	return HEADER_NAMES[header];
+}
+
+HttpHeader HttpRequest::findHeader(const char* name, size_t length) {
+	return g_headerIndex.find(name, length);
 }
 
 // Getters - Body
@@ -428,10 +663,22 @@ size_t HttpRequest::getContentLength() const {
 	return _contentLength;
 }
 
+size_t HttpRequest::getBodySize() const {
+	return _bodySize;
+}
+
 bool HttpRequest::isChunked() const {
 	return _chunked;
 }
 
+void HttpRequest::setBodySink(BodySink* sink) {
+	_bodySink = sink;
+}
+
+BodySink* HttpRequest::getBodySink() const {
+	return _bodySink;
+}
+
 // Getters - State
 HttpParseState HttpRequest::getState() const {
 	return _state;
@@ -441,9 +688,13 @@ const std::string& HttpRequest::getErrorMessage() const {
 	return _errorMessage;
 }
 
+int HttpRequest::getErrorStatus() const {
+	return _errorStatus;
+}
+
 // Getters - Derived info
 std::string HttpRequest::getHost() const {
-	std::string host = getHeader("host");
+	const std::string& host = _knownHeaders[HEADER_HOST];
 	// Remove port if present
 	size_t colonPos = host.find(':');
 	if (colonPos != std::string::npos) {
@@ -453,7 +704,7 @@ std::string HttpRequest::getHost() const {
 }
 
 int HttpRequest::getPort() const {
-	std::string host = getHeader("host");
+	const std::string& host = _knownHeaders[HEADER_HOST];
 	size_t colonPos = host.find(':');
 	if (colonPos != std::string::npos) {
 		std::string portStr = host.substr(colonPos + 1);
@@ -467,14 +718,14 @@ int HttpRequest::getPort() const {
 }
 
 bool HttpRequest::isKeepAlive() const {
-	std::string connection = toLower(getHeader("connection"));
+	const char* connection = _knownHeaders[HEADER_CONNECTION].c_str();
 	
 	if (_httpVersion == "HTTP/1.1") {
 		// HTTP/1.1 defaults to keep-alive
-		return connection != "close";
+		return strcasecmp(connection, "close") != 0;
 	} else {
 		// HTTP/1.0 defaults to close
-		return connection == "keep-alive";
+		return strcasecmp(connection, "keep-alive") == 0;
 	}
 }
 
@@ -0,0 +1,234 @@
+#include "HttpScan.hpp"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define HTTPSCAN_X86 1
+# include <immintrin.h>
+#endif
+
+// Token characters: !#$%&'*+-.^_`|~ DIGIT ALPHA
+static inline bool isTokenChar(unsigned char c) {
+	if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+		return true;
+	}
+	switch (c) {
+		case '!': case '#': case '$': case '%': case '&': case '\'': case '*':
+		case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Scalar versions (also finish the tail the vector loops leave)
+static const char* findNewlineScalar(const char* begin, const char* end) {
+	return static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+}
+
+static size_t tokenLengthFrom(const char* data, size_t size, size_t i) {
+	while (i < size && isTokenChar(static_cast<unsigned char>(data[i]))) {
+		++i;
+	}
+	return i;
+}
+
+static size_t tokenLengthScalar(const char* data, size_t size) {
+	return tokenLengthFrom(data, size, 0);
+}
+
+static void toLowerFrom(char* data, size_t size, size_t i) {
+	for (; i < size; ++i) {
+		if (data[i] >= 'A' && data[i] <= 'Z') {
+			data[i] = static_cast<char>(data[i] | 0x20);
+		}
+	}
+}
+
+static void toLowerScalar(char* data, size_t size) {
+	toLowerFrom(data, size, 0);
+}
+
+#ifdef HTTPSCAN_X86
+
+// SSE2 versions - 16 bytes per step
+
+// Lanes of x within [lo, hi] (unsigned)
+__attribute__((target("sse2")))
+static inline __m128i inRange128(__m128i x, char lo, char hi) {
+	return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8(lo)), x),
+	                     _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(hi)), x));
+}
+
+// Lanes of x holding a token character: visible ASCII minus the delimiters
+// "(),/:;<=>?@[\]{}
+__attribute__((target("sse2")))
+static inline __m128i tokenMask128(__m128i x) {
+	__m128i delimiters = _mm_or_si128(
+		_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')),
+		                          inRange128(x, '(', ')')),
+		             _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(',')),
+		                          _mm_cmpeq_epi8(x, _mm_set1_epi8('/')))),
+		_mm_or_si128(_mm_or_si128(inRange128(x, ':', '@'),
+		                          inRange128(x, '[', ']')),
+		             _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('{')),
+		                          _mm_cmpeq_epi8(x, _mm_set1_epi8('}')))));
+	return _mm_andnot_si128(delimiters, inRange128(x, '!', '~'));
+}
+
+__attribute__((target("sse2")))
+static const char* findNewlineSse2(const char* begin, const char* end) {
+	const __m128i newline = _mm_set1_epi8('\n');
+	const char* p = begin;
+	
+	for (; end - p >= 16; p += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline)));
+		if (mask) {
+			return p + __builtin_ctz(mask);
+		}
+	}
+	return findNewlineScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+static size_t tokenLengthSse2(const char* data, size_t size) {
+	size_t i = 0;
+	
+	for (; i + 16 <= size; i += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(tokenMask128(x)));
+		if (mask != 0xFFFFu) {
+			return i + __builtin_ctz(~mask);
+		}
+	}
+	return tokenLengthFrom(data, size, i);
+}
+
+__attribute__((target("sse2")))
+static void toLowerSse2(char* data, size_t size) {
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	size_t i = 0;
+	
+	for (; i + 16 <= size; i += 16) {
+		__m128i* p = reinterpret_cast<__m128i*>(data + i);
+		__m128i x = _mm_loadu_si128(p);
+		x = _mm_or_si128(x, _mm_and_si128(inRange128(x, 'A', 'Z'), caseBit));
+		_mm_storeu_si128(p, x);
+	}
+	toLowerFrom(data, size, i);
+}
+
+// AVX2 versions - 32 bytes per step
+
+__attribute__((target("avx2")))
+static inline __m256i inRange256(__m256i x, char lo, char hi) {
+	return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(x, _mm256_set1_epi8(lo)), x),
+	                        _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(hi)), x));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i tokenMask256(__m256i x) {
+	__m256i delimiters = _mm256_or_si256(
+		_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')),
+		                                inRange256(x, '(', ')')),
+		                _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(',')),
+		                                _mm256_cmpeq_epi8(x, _mm256_set1_epi8('/')))),
+		_mm256_or_si256(_mm256_or_si256(inRange256(x, ':', '@'),
+		                                inRange256(x, '[', ']')),
+		                _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('{')),
+		                                _mm256_cmpeq_epi8(x, _mm256_set1_epi8('}')))));
+	return _mm256_andnot_si256(delimiters, inRange256(x, '!', '~'));
+}
+
+__attribute__((target("avx2")))
+static const char* findNewlineAvx2(const char* begin, const char* end) {
+	const __m256i newline = _mm256_set1_epi8('\n');
+	const char* p = begin;
+	
+	for (; end - p >= 32; p += 32) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline)));
+		if (mask) {
+			return p + __builtin_ctz(mask);
+		}
+	}
+	return findNewlineScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static size_t tokenLengthAvx2(const char* data, size_t size) {
+	size_t i = 0;
+	
+	for (; i + 32 <= size; i += 32) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(tokenMask256(x)));
+		if (mask != 0xFFFFFFFFu) {
+			return i + __builtin_ctz(~mask);
+		}
+	}
+	return tokenLengthFrom(data, size, i);
+}
+
+__attribute__((target("avx2")))
+static void toLowerAvx2(char* data, size_t size) {
+	const __m256i caseBit = _mm256_set1_epi8(0x20);
+	size_t i = 0;
+	
+	for (; i + 32 <= size; i += 32) {
+		__m256i* p = reinterpret_cast<__m256i*>(data + i);
+		__m256i x = _mm256_loadu_si256(p);
+		x = _mm256_or_si256(x, _mm256_and_si256(inRange256(x, 'A', 'Z'), caseBit));
+		_mm256_storeu_si256(p, x);
+	}
+	toLowerFrom(data, size, i);
+}
+
+#endif
+
+// Implementation table, chosen once before main()
+struct ScanImpl {
+	const char* name;
+	const char* (*findNewline)(const char* begin, const char* end);
+	size_t (*tokenLength)(const char* data, size_t size);
+	void (*toLower)(char* data, size_t size);
+};
+
+static ScanImpl selectImpl() {
+	ScanImpl impl = { "scalar", findNewlineScalar, tokenLengthScalar, toLowerScalar };
+	
+#ifdef HTTPSCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		impl.name = "avx2";
+		impl.findNewline = findNewlineAvx2;
+		impl.tokenLength = tokenLengthAvx2;
+		impl.toLower = toLowerAvx2;
+	} else if (__builtin_cpu_supports("sse2")) {
+		impl.name = "sse2";
+		impl.findNewline = findNewlineSse2;
+		impl.tokenLength = tokenLengthSse2;
+		impl.toLower = toLowerSse2;
+	}
+#endif
+	
+	return impl;
+}
+
+static const ScanImpl g_scan = selectImpl();
+
+// Public entry points
+const char* HttpScan::findNewline(const char* begin, const char* end) {
+	return g_scan.findNewline(begin, end);
+}
+
+size_t HttpScan::tokenLength(const char* data, size_t size) {
+	return g_scan.tokenLength(data, size);
+}
+
+void HttpScan::toLower(char* data, size_t size) {
+	g_scan.toLower(data, size);
+}
+
+const char* HttpScan::implementation() {
+	return g_scan.name;
+}
@@ -5,9 +5,11 @@ LocationConfig::LocationConfig(const std::string& path)
 	: _path(path),
 	  _autoindex(false),
 	  _client_max_body_size(0),
+	  _client_body_buffer_size(0),
 	  _root_set(false),
 	  _autoindex_set(false),
 	  _client_max_body_size_set(false),
+	  _client_body_buffer_size_set(false),
 	  _return_set(false),
 	  _upload_store_set(false) {}
 
@@ -18,6 +20,7 @@ LocationConfig::LocationConfig(const LocationConfig& other)
 	  _index(other._index),
 	  _autoindex(other._autoindex),
 	  _client_max_body_size(other._client_max_body_size),
+	  _client_body_buffer_size(other._client_body_buffer_size),
 	  _allowed_methods(other._allowed_methods),
 	  _return_code(other._return_code),
 	  _return_value(other._return_value),
@@ -27,6 +30,7 @@ LocationConfig::LocationConfig(const LocationConfig& other)
 	  _root_set(other._root_set),
 	  _autoindex_set(other._autoindex_set),
 	  _client_max_body_size_set(other._client_max_body_size_set),
+	  _client_body_buffer_size_set(other._client_body_buffer_size_set),
 	  _return_set(other._return_set),
 	  _upload_store_set(other._upload_store_set),
 	  _seen_index(other._seen_index),
@@ -42,6 +46,7 @@ LocationConfig& LocationConfig::operator=(const LocationConfig& rhs) {
 		_index = rhs._index;
 		_autoindex = rhs._autoindex;
 		_client_max_body_size = rhs._client_max_body_size;
+		_client_body_buffer_size = rhs._client_body_buffer_size;
 		_allowed_methods = rhs._allowed_methods;
 		_return_code = rhs._return_code;
 		_return_value = rhs._return_value;
@@ -51,6 +56,7 @@ LocationConfig& LocationConfig::operator=(const LocationConfig& rhs) {
 		_root_set = rhs._root_set;
 		_autoindex_set = rhs._autoindex_set;
 		_client_max_body_size_set = rhs._client_max_body_size_set;
+		_client_body_buffer_size_set = rhs._client_body_buffer_size_set;
 		_return_set = rhs._return_set;
 		_upload_store_set = rhs._upload_store_set;
 		_seen_index = rhs._seen_index;
@@ -123,6 +129,15 @@ void LocationConfig::setClientMaxBodySize(size_t size) {
 	_client_max_body_size_set = true;
 }
 
+void LocationConfig::setClientBodyBufferSize(size_t size) {
+	if (_client_body_buffer_size_set)
+		throw std::runtime_error("Duplicate 'client_body_buffer_size' directive in location block");
+	if (size > (1024 * 1024 * 1024))
+		throw std::runtime_error("'client_body_buffer_size' cannot exceed 1024M");
+	_client_body_buffer_size = size;
+	_client_body_buffer_size_set = true;
+}
+
 void LocationConfig::setUploadStore(const std::string& store) {
 	if (_upload_store_set)
 		throw std::runtime_error("Duplicate 'upload_store' directive in location block");
@@ -141,6 +156,7 @@ const std::string& LocationConfig::getReturnValue() const { return _return_value
 const std::vector<std::string>& LocationConfig::getCgiPass() const { return _cgi_pass; }
 const std::vector<std::string>& LocationConfig::getCgiExtension() const { return _cgi_extension; }
 size_t LocationConfig::getClientMaxBodySize() const { return _client_max_body_size; }
+size_t LocationConfig::getClientBodyBufferSize() const { return _client_body_buffer_size; }
 const std::string& LocationConfig::getUploadStore() const { return _upload_store; }
 
 // Presence checks
@@ -148,6 +164,7 @@ bool LocationConfig::hasRoot() const { return _root_set; }
 bool LocationConfig::hasIndex() const { return !_index.empty(); }
 bool LocationConfig::hasAutoIndex() const { return _autoindex_set; }
 bool LocationConfig::hasClientMaxBodySize() const { return _client_max_body_size_set; }
+bool LocationConfig::hasClientBodyBufferSize() const { return _client_body_buffer_size_set; }
 
 // Inheritance resolution
 void LocationConfig::inheritFrom(const LocationConfig& parent) {
@@ -174,4 +191,10 @@ void LocationConfig::inheritFrom(const LocationConfig& parent) {
 		_client_max_body_size = parent._client_max_body_size;
 		_client_max_body_size_set = true;
 	}
+	
+	// Inherit client_body_buffer_size if not set
+	if (!_client_body_buffer_size_set && parent._client_body_buffer_size_set) {
+		_client_body_buffer_size = parent._client_body_buffer_size;
+		_client_body_buffer_size_set = true;
+	}
 }
\ No newline at end of file
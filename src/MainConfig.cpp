@@ -0,0 +1,82 @@
+#include "MainConfig.hpp"
+
+// Constructor
+MainConfig::MainConfig()
+	: _worker_processes(1),
+	  _worker_threads(1),
+	  _worker_balance(BALANCE_ROUND_ROBIN),
+	  _edge_triggered(false),
+	  _worker_processes_set(false),
+	  _worker_threads_set(false),
+	  _worker_balance_set(false),
+	  _edge_triggered_set(false) {}
+
+// Copy constructor
+MainConfig::MainConfig(const MainConfig& other)
+	: _worker_processes(other._worker_processes),
+	  _worker_threads(other._worker_threads),
+	  _worker_balance(other._worker_balance),
+	  _edge_triggered(other._edge_triggered),
+	  _worker_processes_set(other._worker_processes_set),
+	  _worker_threads_set(other._worker_threads_set),
+	  _worker_balance_set(other._worker_balance_set),
+	  _edge_triggered_set(other._edge_triggered_set) {}
+
+// Copy assignment operator
+MainConfig& MainConfig::operator=(const MainConfig& rhs) {
+	if (this != &rhs) {
+		_worker_processes = rhs._worker_processes;
+		_worker_threads = rhs._worker_threads;
+		_worker_balance = rhs._worker_balance;
+		_edge_triggered = rhs._edge_triggered;
+		_worker_processes_set = rhs._worker_processes_set;
+		_worker_threads_set = rhs._worker_threads_set;
+		_worker_balance_set = rhs._worker_balance_set;
+		_edge_triggered_set = rhs._edge_triggered_set;
+	}
+	return *this;
+}
+
+// Destructor
+MainConfig::~MainConfig() {}
+
+// Setters
+void MainConfig::setWorkerProcesses(int count) {
+	if (_worker_processes_set)
+		throw std::runtime_error("Duplicate 'worker_processes' directive");
+	_worker_processes = count;
+	_worker_processes_set = true;
+}
+
+void MainConfig::setWorkerThreads(int count) {
+	if (_worker_threads_set)
+		throw std::runtime_error("Duplicate 'worker_threads' directive");
+	_worker_threads = count;
+	_worker_threads_set = true;
+}
+
+void MainConfig::setWorkerBalance(BalanceMode mode) {
+	if (_worker_balance_set)
+		throw std::runtime_error("Duplicate 'worker_balance' directive");
+	_worker_balance = mode;
+	_worker_balance_set = true;
+}
+
+void MainConfig::setEdgeTriggered(bool enabled) {
+	if (_edge_triggered_set)
+		throw std::runtime_error("Duplicate 'edge_triggered' directive");
+	_edge_triggered = enabled;
+	_edge_triggered_set = true;
+}
+
+// Getters
+int MainConfig::getWorkerProcesses() const { return _worker_processes; }
+int MainConfig::getWorkerThreads() const { return _worker_threads; }
+BalanceMode MainConfig::getWorkerBalance() const { return _worker_balance; }
+bool MainConfig::getEdgeTriggered() const { return _edge_triggered; }
+
+// Presence checks
+bool MainConfig::hasWorkerProcesses() const { return _worker_processes_set; }
+bool MainConfig::hasWorkerThreads() const { return _worker_threads_set; }
+bool MainConfig::hasWorkerBalance() const { return _worker_balance_set; }
+bool MainConfig::hasEdgeTriggered() const { return _edge_triggered_set; }
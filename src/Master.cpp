@@ -0,0 +1,211 @@
+#include "Master.hpp"
+#include "Server.hpp"
+#include "Socket.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Signal targets (one master per process; a worker owns one Server)
+static Master* g_master = NULL;
+static Server* g_worker = NULL;
+
+static void masterSignalHandler(int signum) {
+	(void)signum;
+	if (g_master) {
+		g_master->stop();
+	}
+}
+
+static void workerSignalHandler(int signum) {
+	(void)signum;
+	if (g_worker) {
+		g_worker->stop();
+	}
+}
+
+// Constructor
+Master::Master(const std::vector<ServerConfig>& servers, const MainConfig& main)
+	: _servers(servers),
+	  _main(main),
+	  _workers(main.getWorkerProcesses()),
+	  _running(0) {}
+
+// Destructor
+Master::~Master() {
+	if (g_master == this) {
+		g_master = NULL;
+	}
+}
+
+// Fork the workers and supervise them until stopped
+int Master::run() {
+	// Fail fast on unusable addresses instead of in every worker
+	checkListenAddresses();
+	
+	installSignalHandlers();
+	_running = 1;
+	
+	std::cout << "✓ Master " << getpid() << " starting " << _workers.size()
+	          << " worker processes" << std::endl;
+	
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		if (!spawnWorker(i)) {
+			stopWorkers();
+			return 1;
+		}
+	}
+	
+	std::cout << "\n=== Server is running. Press Ctrl+C to stop ===" << std::endl;
+	
+	// Supervise: respawn workers that die while we are running
+	while (_running) {
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		
+		if (pid < 0) {
+			if (errno == EINTR) {
+				continue;  // Signal - re-check _running
+			}
+			break;  // No children left
+		}
+		handleWorkerExit(pid, status);
+	}
+	
+	std::cout << "\nShutting down workers..." << std::endl;
+	stopWorkers();
+	std::cout << "✓ Server stopped gracefully" << std::endl;
+	return 0;
+}
+
+// Request shutdown
+void Master::stop() {
+	_running = 0;
+}
+
+// Install master signal handlers (no SA_RESTART, so waitpid() wakes up)
+void Master::installSignalHandlers() {
+	g_master = this;
+	
+	struct sigaction sa;
+	std::memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = masterSignalHandler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+}
+
+// Bind every listen address once so configuration errors surface in the master
+void Master::checkListenAddresses() const {
+	std::set<ListenAddress> seen;
+	
+	for (size_t i = 0; i < _servers.size(); ++i) {
+		const std::vector<ListenAddress>& addrs = _servers[i].getListenAddresses();
+		for (size_t j = 0; j < addrs.size(); ++j) {
+			if (!seen.insert(addrs[j]).second) {
+				continue;
+			}
+			Socket probe;
+			probe.setReuseAddr(true);
+			probe.setReusePort(true);
+			probe.bind(addrs[j].interface, addrs[j].port);
+		}
+	}
+}
+
+// Fork one worker into the given slot
+bool Master::spawnWorker(size_t slot) {
+	std::cout.flush();
+	std::cerr.flush();
+	
+	pid_t pid = fork();
+	if (pid < 0) {
+		std::cerr << "✗ Failed to fork worker " << slot << ": " << std::strerror(errno) << std::endl;
+		return false;
+	}
+	
+	if (pid == 0) {
+		runWorker(slot);
+	}
+	
+	_workers[slot].pid = pid;
+	_workers[slot].started = std::time(NULL);
+	std::cout << "✓ Worker " << slot << " started (pid " << pid << ")" << std::endl;
+	return true;
+}
+
+// Child side: run a Server with its own event loop and listen sockets
+void Master::runWorker(size_t slot) {
+	g_master = NULL;
+	std::signal(SIGINT, workerSignalHandler);
+	std::signal(SIGTERM, workerSignalHandler);
+	
+	int status = 0;
+	try {
+		Server server(_servers, _main);
+		g_worker = &server;
+		server.run();
+		g_worker = NULL;
+	} catch (const std::exception& e) {
+		std::cerr << "✗ Worker " << slot << ": " << e.what() << std::endl;
+		status = 1;
+	}
+	
+	std::cout.flush();
+	std::cerr.flush();
+	std::exit(status);
+}
+
+// Reap a worker and respawn it in the same slot
+void Master::handleWorkerExit(pid_t pid, int status) {
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		if (_workers[i].pid != pid) {
+			continue;
+		}
+		
+		if (WIFSIGNALED(status)) {
+			std::cerr << "✗ Worker " << i << " (pid " << pid << ") killed by signal "
+			          << WTERMSIG(status) << std::endl;
+		} else {
+			std::cerr << "✗ Worker " << i << " (pid " << pid << ") exited with status "
+			          << WEXITSTATUS(status) << std::endl;
+		}
+		_workers[i].pid = -1;
+		
+		if (!_running) {
+			return;
+		}
+		
+		// Avoid a fork loop when workers die right after starting
+		if (std::time(NULL) - _workers[i].started < RESPAWN_DELAY) {
+			sleep(RESPAWN_DELAY);
+			if (!_running) {
+				return;
+			}
+		}
+		spawnWorker(i);
+		return;
+	}
+}
+
+// Forward SIGTERM to every worker and wait for them
+void Master::stopWorkers() {
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		if (_workers[i].pid > 0) {
+			kill(_workers[i].pid, SIGTERM);
+		}
+	}
+	
+	for (size_t i = 0; i < _workers.size(); ++i) {
+		if (_workers[i].pid <= 0) {
+			continue;
+		}
+		int status;
+		while (waitpid(_workers[i].pid, &status, 0) < 0 && errno == EINTR) {
+		}
+		_workers[i].pid = -1;
+	}
+}
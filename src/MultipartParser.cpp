@@ -0,0 +1,176 @@
+#include "MultipartParser.hpp"
+#include <cstring>
+
+// Constructor
+MultipartParser::MultipartParser(const std::string& boundary, MultipartListener& listener)
+	: _delimiter("\r\n--" + boundary),
+	  _listener(listener),
+	  _state(MULTIPART_PREAMBLE),
+	  _window("\r\n"),  // The first delimiter may open the body, without the CRLF
+	  _line(""),
+	  _lineStart(0),
+	  _errorMessage("") {}
+
+// Destructor
+MultipartParser::~MultipartParser() {}
+
+// Parse the next body bytes
+bool MultipartParser::feed(const char* data, size_t size) {
+	size_t pos = 0;
+	
+	while (pos < size && _state != MULTIPART_EPILOGUE && _state != MULTIPART_ERROR) {
+		switch (_state) {
+			case MULTIPART_PREAMBLE:
+			case MULTIPART_DATA:
+				pos += scanContent(data + pos, size - pos);
+				break;
+			case MULTIPART_BOUNDARY:
+				pos += scanBoundary(data + pos, size - pos);
+				break;
+			case MULTIPART_HEADERS:
+				pos += scanHeaders(data + pos, size - pos);
+				break;
+			case MULTIPART_EPILOGUE:
+			case MULTIPART_ERROR:
+				break;
+		}
+	}
+	
+	return _state != MULTIPART_ERROR;
+}
+
+// Content up to the next delimiter
+size_t MultipartParser::scanContent(const char* data, size_t size) {
+	if (!_window.empty()) {
+		// A delimiter starting in the held bytes ends within the next
+		// delimiter-length bytes, so only those are joined to them
+		size_t held = _window.size();
+		size_t take = (size < _delimiter.size()) ? size : _delimiter.size();
+		_window.append(data, take);
+		
+		size_t at = _delimiter.find(_window.data(), _window.size());
+		if (at < _window.size()) {
+			emit(_window.data(), at);
+			_window.clear();
+			endContent();
+			return at + _delimiter.size() - held;
+		}
+		if (take == _delimiter.size()) {
+			// No delimiter starts in the held bytes: they are content
+			emit(_window.data(), held);
+			_window.clear();
+			return 0;
+		}
+		
+		// Still too short to decide: keep the possible delimiter prefix
+		size_t keep = _delimiter.findPrefix(_window.data(), _window.size());
+		emit(_window.data(), keep);
+		_window.erase(0, keep);
+		return take;
+	}
+	
+	size_t at = _delimiter.find(data, size);
+	if (at < size) {
+		emit(data, at);
+		endContent();
+		return at + _delimiter.size();
+	}
+	
+	size_t keep = _delimiter.findPrefix(data, size);
+	emit(data, keep);
+	_window.assign(data + keep, size - keep);
+	return size;
+}
+
+// Rest of the delimiter line
+size_t MultipartParser::scanBoundary(const char* data, size_t size) {
+	const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+	size_t length = newline ? static_cast<size_t>(newline - data) : size;
+	
+	_line.append(data, length);
+	
+	// Closing delimiter (whatever follows is epilogue)
+	if (_line.size() >= 2 && _line[0] == '-' && _line[1] == '-') {
+		_state = MULTIPART_EPILOGUE;
+		return size;
+	}
+	if (_line.size() > MAX_BOUNDARY_LINE) {
+		fail("Multipart delimiter line too long");
+		return size;
+	}
+	if (!newline) {
+		return size;
+	}
+	
+	// Only transport padding may follow a delimiter
+	if (_line.find_first_not_of(" \t\r") != std::string::npos) {
+		fail("Invalid multipart delimiter line");
+		return size;
+	}
+	
+	_line.clear();
+	_lineStart = 0;
+	_state = MULTIPART_HEADERS;
+	return length + 1;
+}
+
+// Part headers, up to the empty line
+size_t MultipartParser::scanHeaders(const char* data, size_t size) {
+	size_t pos = 0;
+	
+	while (pos < size) {
+		const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+		size_t end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+		
+		_line.append(data + pos, end - pos);
+		pos = end;
+		
+		if (_line.size() > MAX_PART_HEADERS) {
+			fail("Multipart part headers too large");
+			return size;
+		}
+		if (!newline) {
+			break;
+		}
+		
+		// Empty line (LF or CRLF) ends the headers
+		size_t lineLength = _line.size() - _lineStart;
+		if (lineLength == 1 || (lineLength == 2 && _line[_lineStart] == '\r')) {
+			_line.erase(_lineStart);
+			_listener.onPartBegin(_line);
+			_line.clear();
+			_lineStart = 0;
+			_state = MULTIPART_DATA;
+			return pos;
+		}
+		_lineStart = _line.size();
+	}
+	
+	return pos;
+}
+
+// Content bytes
+void MultipartParser::emit(const char* data, size_t size) {
+	if (_state == MULTIPART_DATA && size > 0) {
+		_listener.onPartData(data, size);
+	}
+}
+
+// Delimiter found
+void MultipartParser::endContent() {
+	if (_state == MULTIPART_DATA) {
+		_listener.onPartEnd();
+	}
+	_line.clear();
+	_state = MULTIPART_BOUNDARY;
+}
+
+void MultipartParser::fail(const std::string& message) {
+	_state = MULTIPART_ERROR;
+	_errorMessage = message;
+}
+
+// Getters
+bool MultipartParser::isComplete() const { return _state == MULTIPART_EPILOGUE; }
+bool MultipartParser::hasFailed() const { return _state == MULTIPART_ERROR; }
+const std::string& MultipartParser::getErrorMessage() const { return _errorMessage; }
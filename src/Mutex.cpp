@@ -0,0 +1,31 @@
+#include "Mutex.hpp"
+
+// Constructor
+Mutex::Mutex() {
+	pthread_mutex_init(&_mutex, NULL);
+}
+
+// Destructor
+Mutex::~Mutex() {
+	pthread_mutex_destroy(&_mutex);
+}
+
+// Locking
+void Mutex::lock() {
+	pthread_mutex_lock(&_mutex);
+}
+
+void Mutex::unlock() {
+	pthread_mutex_unlock(&_mutex);
+}
+
+// Constructor - locks the mutex
+ScopedLock::ScopedLock(Mutex& mutex)
+	: _mutex(mutex) {
+	_mutex.lock();
+}
+
+// Destructor - unlocks the mutex
+ScopedLock::~ScopedLock() {
+	_mutex.unlock();
+}
@@ -0,0 +1,93 @@
+#include "OpenFileCache.hpp"
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Constructor
+OpenFileCache::OpenFileCache(size_t maxEntries, time_t validSeconds)
+	: _maxEntries(maxEntries),
+	  _validSeconds(validSeconds) {}
+
+// Destructor
+OpenFileCache::~OpenFileCache() {
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		if (it->second.info.fd >= 0) {
+			close(it->second.info.fd);
+		}
+	}
+	_entries.clear();
+	_lru.clear();
+}
+
+// Find entry
+const OpenFileInfo* OpenFileCache::find(const std::string& path) {
+	EntryMap::iterator it = _entries.find(path);
+	if (it == _entries.end()) {
+		return NULL;
+	}
+
+	Entry& entry = it->second;
+	time_t now = std::time(NULL);
+
+	// Revalidate against disk once the entry is older than the valid interval
+	if (now - entry.validated >= _validSeconds) {
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0 ||
+		    !S_ISREG(st.st_mode) ||
+		    st.st_ino != entry.info.inode ||
+		    st.st_size != entry.info.size ||
+		    st.st_mtime != entry.info.mtime) {
+			erase(it);
+			return NULL;
+		}
+		entry.validated = now;
+	}
+
+	// Move to front of LRU list
+	_lru.splice(_lru.begin(), _lru, entry.lruPos);
+
+	return &entry.info;
+}
+
+// Insert entry
+const OpenFileInfo* OpenFileCache::insert(const std::string& path, const OpenFileInfo& info) {
+	EntryMap::iterator existing = _entries.find(path);
+	if (existing != _entries.end()) {
+		erase(existing);
+	}
+
+	// Evict least recently used entries
+	while (!_lru.empty() && _entries.size() >= _maxEntries) {
+		erase(_entries.find(_lru.back()));
+	}
+
+	_lru.push_front(path);
+
+	Entry& entry = _entries[path];
+	entry.info = info;
+	entry.validated = std::time(NULL);
+	entry.lruPos = _lru.begin();
+
+	return &entry.info;
+}
+
+// Remove entry
+void OpenFileCache::remove(const std::string& path) {
+	EntryMap::iterator it = _entries.find(path);
+	if (it != _entries.end()) {
+		erase(it);
+	}
+}
+
+// Stats
+size_t OpenFileCache::size() const {
+	return _entries.size();
+}
+
+// Close entry fd and erase it
+void OpenFileCache::erase(EntryMap::iterator it) {
+	if (it->second.info.fd >= 0) {
+		close(it->second.info.fd);
+	}
+	_lru.erase(it->second.lruPos);
+	_entries.erase(it);
+}
@@ -1,5 +1,6 @@
 #include "Parser.hpp"
 #include <iostream>
+#include <unistd.h>
 
 // Constructor
 Parser::Parser(Lexer& lexer) : _lexer(lexer) {
@@ -60,6 +61,16 @@ const DirectiveSpec* Parser::findDirectiveInServer(const std::string& name) cons
 	return NULL;
 }
 
+// Directive lookup - for main context
+const DirectiveSpec* Parser::findDirectiveInMain(const std::string& name) const {
+	for (size_t i = 0; i < sizeof(g_directives) / sizeof(g_directives[0]); ++i) {
+		if (g_directives[i].name == name && g_directives[i].scope == SCOPE_MAIN) {
+			return &g_directives[i];
+		}
+	}
+	return NULL;
+}
+
 // Directive lookup - for location context
 const DirectiveSpec* Parser::findDirectiveInLocation(const std::string& name) const {
 	for (size_t i = 0; i < sizeof(g_directives) / sizeof(g_directives[0]); ++i) {
@@ -226,15 +237,46 @@ static size_t parseSize(const Token& t) {
 	return static_cast<size_t>(base) * multiplier;
 }
 
+static time_t parseTime(const Token& t) {
+	const std::string& s = t.value;
+	char* end = NULL;
+	errno = 0;
+	
+	long base = std::strtol(s.c_str(), &end, 10);
+	
+	if (errno != 0 || end == s.c_str() || base < 0)
+		throw ConfigError("Invalid time value", t);
+	
+	time_t multiplier = 1;
+	
+	if (*end != '\0') {
+		if (*(end + 1) != '\0')
+			throw ConfigError("Invalid time unit (use s, m, or h)", t);
+		
+		switch (*end) {
+			case 's': multiplier = 1; break;
+			case 'm': multiplier = 60; break;
+			case 'h': multiplier = 3600; break;
+			default:
+				throw ConfigError("Invalid time unit (use s, m, or h)", t);
+		}
+	}
+	
+	return static_cast<time_t>(base) * multiplier;
+}
+
 // Main parse entry point
 std::vector<ServerConfig> Parser::parse() {
 	std::vector<ServerConfig> servers;
+	std::set<std::string> seenMain;
 	
 	while (_current.type != TOK_EOF) {
 		if (_current.type == TOK_IDENT && _current.value == "server") {
 			parseServerBlock(servers);
+		} else if (_current.type == TOK_IDENT) {
+			parseMainDirective(seenMain);
 		} else {
-			throw ConfigError("Expected 'server' block at top level", _current);
+			throw ConfigError("Expected 'server' block or directive at top level", _current);
 		}
 	}
 	
@@ -245,11 +287,42 @@ std::vector<ServerConfig> Parser::parse() {
 	for (size_t i = 0; i < servers.size(); ++i) {
 		validateAndApplyDefaults(servers[i]);
 	}
+	applyMainDefaults();
 	
+	debugPrintMain();
 	debugPrintServers(servers);
 	return servers;
 }
 
+// Main-context directives
+const MainConfig& Parser::getMainConfig() const {
+	return _main;
+}
+
+// Parse main-context directive
+void Parser::parseMainDirective(std::set<std::string>& seen) {
+	Token name = expect(TOK_IDENT, "Expected directive name");
+	
+	const DirectiveSpec* spec = findDirectiveInMain(name.value);
+	if (!spec) {
+		if (findDirectiveInServer(name.value))
+			throw ConfigError("Directive '" + name.value + "' is only allowed inside a server block", name);
+		throw ConfigError("Invalid directive in main context: '" + name.value + "'", name);
+	}
+	
+	// Check for duplicates
+	if (spec->arity == SINGLE_VALUE && seen.count(name.value))
+		throw ConfigError("Duplicate directive: '" + name.value + "'", name);
+	
+	seen.insert(name.value);
+	
+	// Collect values
+	std::vector<Token> values = collectValuesUntilSemicolon();
+	
+	// Apply to main config
+	applyMainDirective(name, values);
+}
+
 // Parse server block
 void Parser::parseServerBlock(std::vector<ServerConfig>& servers) {
 	expect(TOK_IDENT, "Expected 'server'");
@@ -341,6 +414,77 @@ void Parser::parseLocationDirective(LocationConfig& location, std::set<std::stri
 	applyLocationDirective(location, name, values);
 }
 
+// Apply main-context directives
+void Parser::applyMainDirective(const Token& name, const std::vector<Token>& values) {
+	const std::string& dir = name.value;
+	
+	// worker_processes (count, or auto = one per online CPU)
+	if (dir == "worker_processes") {
+		if (values.size() != 1)
+			throw ConfigError("'worker_processes' expects exactly one argument (count or auto)", name);
+		
+		if (values[0].value == "auto") {
+			long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+			_main.setWorkerProcesses(cpus > 0 ? static_cast<int>(cpus) : 1);
+			return;
+		}
+		
+		int count = toInt(values[0]);
+		if (count <= 0 || count > MainConfig::MAX_WORKER_PROCESSES)
+			throw ConfigError("'worker_processes' must be between 1 and 1024 (or auto)", values[0]);
+		_main.setWorkerProcesses(count);
+		return;
+	}
+	
+	// worker_threads (event loop threads per process, or auto = one per online CPU)
+	if (dir == "worker_threads") {
+		if (values.size() != 1)
+			throw ConfigError("'worker_threads' expects exactly one argument (count or auto)", name);
+		
+		if (values[0].value == "auto") {
+			long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+			_main.setWorkerThreads(cpus > 0 ? static_cast<int>(cpus) : 1);
+			return;
+		}
+		
+		int count = toInt(values[0]);
+		if (count <= 0 || count > MainConfig::MAX_WORKER_THREADS)
+			throw ConfigError("'worker_threads' must be between 1 and 256 (or auto)", values[0]);
+		_main.setWorkerThreads(count);
+		return;
+	}
+	
+	// worker_balance (round_robin | least_conn)
+	if (dir == "worker_balance") {
+		if (values.size() != 1)
+			throw ConfigError("'worker_balance' expects exactly one argument", name);
+		
+		if (values[0].value == "round_robin")
+			_main.setWorkerBalance(BALANCE_ROUND_ROBIN);
+		else if (values[0].value == "least_conn")
+			_main.setWorkerBalance(BALANCE_LEAST_CONN);
+		else
+			throw ConfigError("'worker_balance' must be 'round_robin' or 'least_conn'", values[0]);
+		return;
+	}
+	
+	// edge_triggered (on | off) - client sockets use EPOLLET
+	if (dir == "edge_triggered") {
+		if (values.size() != 1)
+			throw ConfigError("'edge_triggered' expects exactly one argument (on or off)", name);
+		
+		if (values[0].value == "on")
+			_main.setEdgeTriggered(true);
+		else if (values[0].value == "off")
+			_main.setEdgeTriggered(false);
+		else
+			throw ConfigError("'edge_triggered' must be 'on' or 'off'", values[0]);
+		return;
+	}
+	
+	throw ConfigError("Unhandled main directive: '" + dir + "'", name);
+}
+
 // Apply server directives
 void Parser::applyServerDirective(ServerConfig& server, const Token& name, const std::vector<Token>& values) {
 	const std::string& dir = name.value;
@@ -440,6 +584,85 @@ void Parser::applyServerDirective(ServerConfig& server, const Token& name, const
 		return;
 	}
 	
+	// client_body_buffer_size (inheritable)
+	if (dir == "client_body_buffer_size") {
+		if (values.size() != 1)
+			throw ConfigError("'client_body_buffer_size' expects exactly one argument", name);
+		
+		server.setClientBodyBufferSize(parseSize(values[0]));
+		return;
+	}
+	
+	// open_file_cache (max entries, or off)
+	if (dir == "open_file_cache") {
+		if (values.size() != 1)
+			throw ConfigError("'open_file_cache' expects exactly one argument (max entries or off)", name);
+		
+		if (values[0].value == "off") {
+			server.setOpenFileCache(0);
+			return;
+		}
+		
+		int entries = toInt(values[0]);
+		if (entries <= 0)
+			throw ConfigError("'open_file_cache' must be a positive number of entries", values[0]);
+		server.setOpenFileCache(static_cast<size_t>(entries));
+		return;
+	}
+	
+	// open_file_cache_valid (revalidation interval)
+	if (dir == "open_file_cache_valid") {
+		if (values.size() != 1)
+			throw ConfigError("'open_file_cache_valid' expects exactly one argument", name);
+		
+		server.setOpenFileCacheValid(parseTime(values[0]));
+		return;
+	}
+	
+	// file_cache_size (total bytes of prebuilt responses, or off)
+	if (dir == "file_cache_size") {
+		if (values.size() != 1)
+			throw ConfigError("'file_cache_size' expects exactly one argument (size or off)", name);
+		
+		if (values[0].value == "off") {
+			server.setFileCacheSize(0);
+			return;
+		}
+		
+		server.setFileCacheSize(parseSize(values[0]));
+		return;
+	}
+	
+	// file_cache_max_entry (largest file kept in memory)
+	if (dir == "file_cache_max_entry") {
+		if (values.size() != 1)
+			throw ConfigError("'file_cache_max_entry' expects exactly one argument", name);
+		
+		server.setFileCacheMaxEntry(parseSize(values[0]));
+		return;
+	}
+	
+	// Connection timeouts, one per phase (header, body, keep-alive idle, send)
+	if (dir == "client_header_timeout" || dir == "client_body_timeout" ||
+	    dir == "keepalive_timeout" || dir == "send_timeout") {
+		if (values.size() != 1)
+			throw ConfigError("'" + dir + "' expects exactly one argument", name);
+		
+		time_t seconds = parseTime(values[0]);
+		if (seconds <= 0)
+			throw ConfigError("'" + dir + "' must be at least 1s", values[0]);
+		
+		if (dir == "client_header_timeout")
+			server.setClientHeaderTimeout(seconds);
+		else if (dir == "client_body_timeout")
+			server.setClientBodyTimeout(seconds);
+		else if (dir == "keepalive_timeout")
+			server.setKeepaliveTimeout(seconds);
+		else
+			server.setSendTimeout(seconds);
+		return;
+	}
+	
 	throw ConfigError("Unhandled server directive: '" + dir + "'", name);
 }
 
@@ -594,6 +817,15 @@ void Parser::applyLocationDirective(LocationConfig& location, const Token& name,
 		return;
 	}
 	
+	// client_body_buffer_size (inheritable)
+	if (dir == "client_body_buffer_size") {
+		if (values.size() != 1)
+			throw ConfigError("'client_body_buffer_size' expects exactly one argument", name);
+		
+		location.setClientBodyBufferSize(parseSize(values[0]));
+		return;
+	}
+	
 	throw ConfigError("Unhandled location directive: '" + dir + "'", name);
 }
 
@@ -623,6 +855,10 @@ void Parser::applyServerDefaults(ServerConfig& server) {
 	if (!server.hasClientMaxBodySize())
 		server.setClientMaxBodySize(1048576); // 1MB
 	
+	// Default: client_body_buffer_size = 16K
+	if (!server.hasClientBodyBufferSize())
+		server.setClientBodyBufferSize(16 * 1024);
+	
 	// Default: autoindex = off
 	if (!server.hasAutoIndex())
 		server.setAutoIndex(false);
@@ -630,6 +866,52 @@ void Parser::applyServerDefaults(ServerConfig& server) {
 	// Default: index = index.html
 	if (!server.hasIndex())
 		server.addIndex("index.html");
+	
+	// Default: open_file_cache off
+	if (!server.hasOpenFileCache())
+		server.setOpenFileCache(0);
+	
+	// Default: open_file_cache_valid = 60s
+	if (!server.hasOpenFileCacheValid())
+		server.setOpenFileCacheValid(60);
+	
+	// Default: file_cache_size off
+	if (!server.hasFileCacheSize())
+		server.setFileCacheSize(0);
+	
+	// Default: file_cache_max_entry = 64K
+	if (!server.hasFileCacheMaxEntry())
+		server.setFileCacheMaxEntry(64 * 1024);
+	
+	// Default: client_header_timeout = client_body_timeout = send_timeout = 60s
+	if (!server.hasClientHeaderTimeout())
+		server.setClientHeaderTimeout(60);
+	if (!server.hasClientBodyTimeout())
+		server.setClientBodyTimeout(60);
+	if (!server.hasSendTimeout())
+		server.setSendTimeout(60);
+	
+	// Default: keepalive_timeout = 75s
+	if (!server.hasKeepaliveTimeout())
+		server.setKeepaliveTimeout(75);
+}
+
+void Parser::applyMainDefaults() {
+	// Default: worker_processes 1 (single process, no master)
+	if (!_main.hasWorkerProcesses())
+		_main.setWorkerProcesses(1);
+	
+	// Default: worker_threads 1 (the accepting thread runs the event loop itself)
+	if (!_main.hasWorkerThreads())
+		_main.setWorkerThreads(1);
+	
+	// Default: worker_balance round_robin
+	if (!_main.hasWorkerBalance())
+		_main.setWorkerBalance(BALANCE_ROUND_ROBIN);
+	
+	// Default: edge_triggered off (level-triggered epoll)
+	if (!_main.hasEdgeTriggered())
+		_main.setEdgeTriggered(false);
 }
 
 void Parser::applyLocationDefaults(LocationConfig& location, ServerConfig& server) {
@@ -643,6 +925,14 @@ void Parser::applyLocationDefaults(LocationConfig& location, ServerConfig& serve
 		}
 	}
 	
+	// Default: client_body_buffer_size = 16K (if not inherited)
+	if (!location.hasClientBodyBufferSize()) {
+		if (server.hasClientBodyBufferSize())
+			location.setClientBodyBufferSize(server.getClientBodyBufferSize());
+		else
+			location.setClientBodyBufferSize(16 * 1024);
+	}
+	
 	// Default: autoindex = off (if not inherited)
 	if (!location.hasAutoIndex()) {
 		bool turn;
@@ -674,6 +964,15 @@ void Parser::applyLocationDefaults(LocationConfig& location, ServerConfig& serve
 }
 
 // Debug printing
+void Parser::debugPrintMain() const {
+	std::cout << "\n=== Main Context ===\n";
+	std::cout << "  worker_processes: " << _main.getWorkerProcesses() << "\n";
+	std::cout << "  worker_threads: " << _main.getWorkerThreads() << "\n";
+	std::cout << "  worker_balance: "
+	          << (_main.getWorkerBalance() == BALANCE_LEAST_CONN ? "least_conn" : "round_robin") << "\n";
+	std::cout << "  edge_triggered: " << (_main.getEdgeTriggered() ? "on" : "off") << "\n";
+}
+
 void Parser::debugPrintServers(const std::vector<ServerConfig>& servers) const {
 	std::cout << "\n=== Parsed Configuration ===\n";
 	for (size_t i = 0; i < servers.size(); ++i) {
@@ -739,6 +1038,32 @@ void Parser::debugPrintServer(const ServerConfig& s) const {
 		std::cout << " (" << (s.getClientMaxBodySize() / 1024.0) << " KB)";
 	std::cout << "\n";
 	
+	// client_body_buffer_size
+	std::cout << "  client_body_buffer_size: " << s.getClientBodyBufferSize() << " bytes\n";
+	
+	// open_file_cache
+	std::cout << "  open_file_cache: ";
+	if (s.getOpenFileCache() > 0)
+		std::cout << s.getOpenFileCache() << " entries (valid " << s.getOpenFileCacheValid() << "s)";
+	else
+		std::cout << "off";
+	std::cout << "\n";
+	
+	// timeouts
+	std::cout << "  timeouts: header " << s.getClientHeaderTimeout()
+	          << "s, body " << s.getClientBodyTimeout()
+	          << "s, keepalive " << s.getKeepaliveTimeout()
+	          << "s, send " << s.getSendTimeout() << "s\n";
+	
+	// file_cache_size
+	std::cout << "  file_cache: ";
+	if (s.getFileCacheSize() > 0)
+		std::cout << (s.getFileCacheSize() / 1024.0) << " KB (max entry "
+		          << (s.getFileCacheMaxEntry() / 1024.0) << " KB)";
+	else
+		std::cout << "off";
+	std::cout << "\n";
+	
 	// error_page
 	const std::map<int, std::string>& errors = s.getErrorPages();
 	if (!errors.empty()) {
@@ -807,6 +1132,14 @@ void Parser::debugPrintLocation(const LocationConfig& l) const {
 	}
 	std::cout << "\n";
 	
+	// client_body_buffer_size
+	std::cout << "    client_body_buffer_size: ";
+	if (l.hasClientBodyBufferSize())
+		std::cout << l.getClientBodyBufferSize() << " bytes";
+	else
+		std::cout << "(not set)";
+	std::cout << "\n";
+	
 	// allowed_methods
 	std::cout << "    allowed_methods: ";
 	const std::vector<std::string>& methods = l.getAllowedMethods();
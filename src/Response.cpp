@@ -1,13 +1,20 @@
 #include "Response.hpp"
 #include <iostream>
+#include <cstdio>
+#include <ctime>
 
 // Constructor
-Response::Response()
+Response::Response(Arena* arena)
 	: _statusCode(200),
 	  _statusText("OK"),
 	  _contentType("text/html"),
 	  _body(""),
-	  _keepAlive(true) {}
+	  _fileFd(-1),
+	  _fileLength(0),
+	  _fileParts(ArenaAllocator<FilePart>(arena)),
+	  _fileTrailer(""),
+	  _keepAlive(true),
+	  _headers(ArenaAllocator<Header>(arena)) {}
 
 // Destructor
 Response::~Response() {}
@@ -18,6 +25,10 @@ void Response::reset() {
 	_statusText = "OK";
 	_contentType = "text/html";
 	_body.clear();
+	_fileFd = -1;
+	_fileLength = 0;
+	_fileParts.clear();
+	_fileTrailer.clear();
 	_keepAlive = true;
 	_headers.clear();
 }
@@ -39,23 +50,114 @@ void Response::setBody(const std::string& body) {
 	_body = body;
 }
 
+void Response::swapBody(std::string& body) {
+	_body.swap(body);
+}
+
+void Response::setFileBody(int fd, off_t length) {
+	_body.clear();
+	_fileFd = fd;
+	_fileLength = length;
+	_fileParts.assign(1, FilePart());
+	_fileParts[0].length = length;
+	_fileTrailer.clear();
+}
+
+// 206 Partial Content from file ranges: one range is sent as is,
+// several are framed as multipart/byteranges (RFC 7233 section 4.1)
+void Response::setFileRanges(int fd, const std::vector<ByteRange>& ranges, off_t fileSize) {
+	_body.clear();
+	_fileFd = fd;
+	_fileParts.clear();
+	_fileTrailer.clear();
+	_statusCode = 206;
+	_statusText = "Partial Content";
+	
+	if (ranges.size() == 1) {
+		std::stringstream contentRange;
+		contentRange << "bytes " << ranges[0].offset << "-"
+		             << (ranges[0].offset + ranges[0].length - 1) << "/" << fileSize;
+		setHeader("Content-Range", contentRange.str());
+		
+		_fileParts.push_back(FilePart());
+		_fileParts[0].offset = ranges[0].offset;
+		_fileParts[0].length = ranges[0].length;
+		_fileLength = ranges[0].length;
+		return;
+	}
+	
+	// Boundary only has to be absent from the framing we generate
+	// (the counter is shared by all event loop threads)
+	static unsigned long counter = 0;
+	std::stringstream boundary;
+	boundary << "webserv_" << std::hex << static_cast<unsigned long>(std::time(NULL))
+	         << "_" << __sync_add_and_fetch(&counter, 1);
+	
+	_fileLength = 0;
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		std::stringstream prefix;
+		if (i > 0) {
+			prefix << "\r\n";
+		}
+		prefix << "--" << boundary.str() << "\r\n"
+		       << "Content-Type: " << _contentType << "\r\n"
+		       << "Content-Range: bytes " << ranges[i].offset << "-"
+		       << (ranges[i].offset + ranges[i].length - 1) << "/" << fileSize << "\r\n"
+		       << "\r\n";
+		
+		FilePart part;
+		part.prefix = prefix.str();
+		part.offset = ranges[i].offset;
+		part.length = ranges[i].length;
+		_fileParts.push_back(part);
+		_fileLength += static_cast<off_t>(part.prefix.size()) + part.length;
+	}
+	
+	_fileTrailer = "\r\n--" + boundary.str() + "--\r\n";
+	_fileLength += static_cast<off_t>(_fileTrailer.size());
+	_contentType = "multipart/byteranges; boundary=" + boundary.str();
+}
+
 void Response::setKeepAlive(bool keepAlive) {
 	_keepAlive = keepAlive;
 }
 
 // Add/set headers
 void Response::setHeader(const std::string& name, const std::string& value) {
-	_headers[name] = value;
+	Header* header = findHeader(name);
+	if (header) {
+		header->second.assign(value.data(), value.size());
+		return;
+	}
+	
+	ArenaAllocator<char> alloc(_headers.get_allocator());
+	_headers.push_back(Header(ArenaString(name.data(), name.size(), alloc),
+	                          ArenaString(value.data(), value.size(), alloc)));
 }
 
 void Response::addHeader(const std::string& name, const std::string& value) {
 	// If header exists, append with comma (per HTTP spec for most headers)
-	std::map<std::string, std::string>::iterator it = _headers.find(name);
-	if (it != _headers.end()) {
-		it->second += ", " + value;
+	Header* header = findHeader(name);
+	if (header) {
+		header->second.append(", ");
+		header->second.append(value.data(), value.size());
 	} else {
-		_headers[name] = value;
+		setHeader(name, value);
+	}
+}
+
+// Find header by exact name
+Response::Header* Response::findHeader(const std::string& name) {
+	for (size_t i = 0; i < _headers.size(); ++i) {
+		if (_headers[i].first.compare(0, ArenaString::npos, name.data(), name.size()) == 0) {
+			return &_headers[i];
+		}
 	}
+	return NULL;
+}
+
+const Response::Header* Response::findHeader(const std::string& name) const {
+	return const_cast<Response*>(this)->findHeader(name);
 }
 
 // Getters
@@ -75,55 +177,134 @@ const std::string& Response::getBody() const {
 	return _body;
 }
 
+bool Response::hasFileBody() const {
+	return _fileFd >= 0;
+}
+
+int Response::getFileFd() const {
+	return _fileFd;
+}
+
+off_t Response::getFileLength() const {
+	return _fileLength;
+}
+
+const Response::FilePartList& Response::getFileParts() const {
+	return _fileParts;
+}
+
+const std::string& Response::getFileTrailer() const {
+	return _fileTrailer;
+}
+
 bool Response::isKeepAlive() const {
 	return _keepAlive;
 }
 
 std::string Response::getHeader(const std::string& name) const {
-	std::map<std::string, std::string>::const_iterator it = _headers.find(name);
-	if (it != _headers.end()) {
-		return it->second;
+	const Header* header = findHeader(name);
+	if (header) {
+		return std::string(header->second.data(), header->second.size());
 	}
 	return "";
 }
 
-const std::map<std::string, std::string>& Response::getHeaders() const {
+const Response::HeaderList& Response::getHeaders() const {
 	return _headers;
 }
 
-// Build the complete HTTP response string
-std::string Response::build() const {
-	std::stringstream response;
+// Append a decimal number without going through a stringstream
+template <typename String>
+static void appendNumber(String& out, long long value) {
+	char buf[24];
+	int len = std::snprintf(buf, sizeof(buf), "%lld", value);
+	out.append(buf, static_cast<size_t>(len));
+}
+
+// Whether the status never carries a body (RFC 7230 section 3.3.3)
+bool Response::isBodyless() const {
+	return (_statusCode >= 100 && _statusCode < 200) ||
+	       _statusCode == 204 || _statusCode == 304;
+}
+
+// Append the status line and header block (ends with the empty line)
+template <typename String>
+void Response::appendHeaders(String& head) const {
+	head.reserve(256);
 	
 	// Status line
-	response << "HTTP/1.1 " << _statusCode << " " << _statusText << "\r\n";
-	
-	// Content-Type header
-	response << "Content-Type: " << _contentType << "\r\n";
+	head += "HTTP/1.1 ";
+	appendNumber(head, _statusCode);
+	head += " ";
+	head.append(_statusText.data(), _statusText.size());
+	head += "\r\n";
 	
-	// Content-Length header
-	response << "Content-Length: " << _body.size() << "\r\n";
+	if (!isBodyless()) {
+		// Content-Type header
+		head += "Content-Type: ";
+		head.append(_contentType.data(), _contentType.size());
+		head += "\r\n";
+		
+		// Content-Length header
+		head += "Content-Length: ";
+		if (hasFileBody()) {
+			appendNumber(head, _fileLength);
+		} else {
+			appendNumber(head, static_cast<long long>(_body.size()));
+		}
+		head += "\r\n";
+	}
 	
 	// Connection header
 	if (_keepAlive) {
-		response << "Connection: keep-alive\r\n";
+		head += "Connection: keep-alive\r\n";
 	} else {
-		response << "Connection: close\r\n";
+		head += "Connection: close\r\n";
 	}
 	
 	// Additional headers
-	for (std::map<std::string, std::string>::const_iterator it = _headers.begin();
-	     it != _headers.end(); ++it) {
-		response << it->first << ": " << it->second << "\r\n";
+	for (size_t i = 0; i < _headers.size(); ++i) {
+		head.append(_headers[i].first.data(), _headers[i].first.size());
+		head += ": ";
+		head.append(_headers[i].second.data(), _headers[i].second.size());
+		head += "\r\n";
 	}
 	
 	// Empty line to end headers
-	response << "\r\n";
+	head += "\r\n";
+}
+
+// Build the status line and header block
+std::string Response::buildHeaders() const {
+	std::string head;
+	appendHeaders(head);
+	return head;
+}
+
+ArenaString Response::buildArenaHeaders() const {
+	ArenaString head(_headers.get_allocator());
+	appendHeaders(head);
+	return head;
+}
+
+// Build the complete HTTP response string
+std::string Response::build() const {
+	std::string response = buildHeaders();
 	
-	// Body
-	response << _body;
+	// Body (a file body is sent separately by the client)
+	if (!isBodyless()) {
+		response += _body;
+	}
 	
-	return response.str();
+	return response;
+}
+
+// Move the in-memory body out (left empty; call after buildHeaders())
+void Response::takeBody(std::string& out) {
+	out.clear();
+	if (!isBodyless()) {
+		out.swap(_body);
+	}
 }
 
 // Static: Get status text for code
@@ -163,6 +344,7 @@ std::string Response::getStatusTextForCode(int code) {
 		case 413: return "Payload Too Large";
 		case 414: return "URI Too Long";
 		case 415: return "Unsupported Media Type";
+		case 416: return "Range Not Satisfiable";
 		case 418: return "I'm a teapot";
 		case 429: return "Too Many Requests";
 		
@@ -1,29 +1,90 @@
 #include "Server.hpp"
 #include "Response.hpp"
+#include "HttpScan.hpp"
+#include "BodySpool.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <unistd.h>
 #include <sys/wait.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <cerrno>
+
+// Where a large non-upload body (e.g. a CGI request) is spooled
+static const char* const BODY_TEMP_DIR = "/tmp";
 
 // Constructor
-Server::Server(const std::vector<ServerConfig>& servers)
+Server::Server(const std::vector<ServerConfig>& servers, const MainConfig& main)
 	: _servers(servers),
-	  _clientManager(_epoll),
-	  _router(servers),
+	  _main(main),
+	  _clientManager(_epoll, _fds, _buffers),
+	  _router(_servers),
+	  _fileServer(new FileServer()),
+	  _ownsFileServer(true),
+	  _nextShard(0),
+	  _load(0),
 	  _running(false),
-	  _lastTimeoutCheck(std::time(NULL)) {
+	  _now(TimerWheel::now()) {
+	
+	_handoffPipe[0] = -1;
+	_handoffPipe[1] = -1;
 	
 	std::cout << "✓ Router initialized" << std::endl;
+	std::cout << "✓ HTTP scanner: " << HttpScan::implementation() << std::endl;
+	std::cout << "✓ Event mode: " << (main.getEdgeTriggered() ? "edge-triggered" : "level-triggered")
+	          << std::endl;
 	std::cout << "✓ File server initialized" << std::endl;
 	std::cout << "✓ CGI handler initialized" << std::endl;
 	std::cout << "✓ Upload handler initialized" << std::endl;
 }
 
+// Worker thread constructor - routes against the root's server blocks, so
+// route.server pointers (the file cache keys) are the same in every thread
+Server::Server(Server& root, int index)
+	: _servers(root._servers),
+	  _main(root._main),
+	  _clientManager(_epoll, _fds, _buffers),
+	  _router(root._servers),
+	  _fileServer(root._fileServer),
+	  _ownsFileServer(false),
+	  _nextShard(0),
+	  _load(0),
+	  _running(false),
+	  _now(TimerWheel::now()) {
+	
+	if (pipe2(_handoffPipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+		std::stringstream ss;
+		ss << "Failed to create handoff pipe for worker thread " << index
+		   << ": " << std::strerror(errno);
+		throw std::runtime_error(ss.str());
+	}
+	_epoll.add(_handoffPipe[0], EVENT_READ, _fds.acquire(_handoffPipe[0], FD_HANDOFF));
+}
+
 // Destructor
 Server::~Server() {
 	stop();
+	stopShards();
+	
+	// Kill CGI processes still running
+	for (size_t i = 0; i < _fds.size(); ++i) {
+		FdSlot* slot = _fds.find(static_cast<int>(i));
+		if (slot && slot->kind == FD_CGI_STDOUT) {
+			slot->cgi->client = NULL;  // Clients are going away too - nothing to resume
+			cleanupCgiSession(slot->cgi, false);
+		}
+	}
+	
+	if (_handoffPipe[0] >= 0) {
+		close(_handoffPipe[0]);
+	}
+	if (_handoffPipe[1] >= 0) {
+		close(_handoffPipe[1]);
+	}
+	if (_ownsFileServer) {
+		delete _fileServer;
+	}
 	
 	// Clean up listen sockets
 	for (size_t i = 0; i < _listenSockets.size(); ++i) {
@@ -56,11 +117,17 @@ void Server::setupListenSockets() {
 			sock->setReuseAddr(true); 
 			// for the old fd, need to use this to avoid "address already in use" errors 
 			//when restarting quickly, as the old sockets may still be in the TIME_WAIT state
+			if (_main.getWorkerProcesses() > 1) {
+				// Each worker binds its own copy; the kernel balances accepts between them
+				sock->setReusePort(true);
+			}
 			sock->setNonBlocking(true);
 			sock->bind(addrs[j].interface, addrs[j].port);
 			sock->listen();
 			
-			_epoll.add(sock->getFd(), EVENT_READ);
+			FdSlot* slot = _fds.acquire(sock->getFd(), FD_LISTEN);
+			slot->socket = sock;
+			_epoll.add(sock->getFd(), EVENT_READ, slot);
 			_listenSockets.push_back(sock);
 			
 			std::cout << "✓ Listening on " 
@@ -83,10 +150,14 @@ void Server::run() {
 	}
 	
 	setupListenSockets();
+	if (_main.getWorkerThreads() > 1) {
+		startShards();
+	}
 	printStartupInfo();
 	
 	_running = true;
 	eventLoop();
+	stopShards();
 }
 
 // Stop server
@@ -107,41 +178,78 @@ void Server::eventLoop() {
 	std::vector<Event> events;
 	
 	while (_running) {
-		// collect events for a specific amount of time "EPOLL_TIMEOUT"
-		int numEvents = _epoll.wait(events, EPOLL_TIMEOUT);
+		// Sleep until the next event or the nearest timer deadline (just poll
+		// when clients still have I/O left from the last iteration)
+		int timeout = _readyClients.empty() ? _timers.nextTimeout(TimerWheel::nowMs()) : 0;
+		int numEvents = _epoll.wait(events, timeout);
+		_now = TimerWheel::now();
 		
 		// Process every events
 		for (int i = 0; i < numEvents; ++i) {
-			int fd = events[i].fd;
+			// The slot says what the fd is - no lookup needed
+			FdSlot* slot = static_cast<FdSlot*>(events[i].data);
 			
-			if (isListenSocket(fd)) {
-				if (events[i].isReadable()) {
-					Socket* listenSock = findListenSocket(fd);
-					if (listenSock) {
-						handleNewConnection(listenSock);
+			switch (slot->kind) {
+				case FD_LISTEN:
+					if (events[i].isReadable()) {
+						handleNewConnection(slot->socket);
 					}
-				}
-			} else if (isCgiPipe(fd)) {
-				handleCgiEvent(events[i]);
-			} else if (_clientManager.hasClient(fd)) {
-				handleClientEvent(events[i]);
+					break;
+				case FD_HANDOFF:
+					acceptHandoffs();
+					break;
+				case FD_CLIENT:
+					handleClientEvent(slot, events[i]);
+					break;
+				case FD_CGI_STDOUT:
+				case FD_CGI_STDIN:
+					handleCgiEvent(slot, events[i]);
+					break;
+				case FD_FREE:
+					break;  // Closed by an earlier event of this batch
 			}
 		}
 		
-		// Check for timeouts
-		checkTimeouts();
-		checkCgiTimeouts();
+		// Continue clients that used up their budget
+		serviceReadyClients();
+		
+		// Fire due timers
+		expireTimers();
+		
+		// Published for least_conn balancing
+		_load = static_cast<int>(_clientManager.getClientCount());
 	}
 	
 	std::cout << "✓ Server stopped gracefully" << std::endl;
 }
 
+// Name of a client timeout phase, for logging
+static const char* timeoutName(ClientTimeout phase) {
+	switch (phase) {
+		case TIMEOUT_HEADER:    return "client_header_timeout";
+		case TIMEOUT_BODY:      return "client_body_timeout";
+		case TIMEOUT_KEEPALIVE: return "keepalive_timeout";
+		case TIMEOUT_SEND:      return "send_timeout";
+		default:                return "timeout";
+	}
+}
+
 // Check and handle client timeouts
-void Server::checkTimeouts() {
-	time_t now = std::time(NULL);
-	if (now - _lastTimeoutCheck >= 1) {
-		_clientManager.checkTimeouts(CLIENT_TIMEOUT);
-		_lastTimeoutCheck = now;
+void Server::expireTimers() {
+	// One timer at a time: handling one may free the owner of another
+	TimerNode* timer;
+	while ((timer = _timers.popExpired(_now)) != NULL) {
+		FdSlot* slot = static_cast<FdSlot*>(timer->data);
+		
+		if (slot->kind == FD_CLIENT) {
+			std::cout << "Client " << slot->fd << " timed out ("
+			          << timeoutName(slot->client->getTimeoutPhase())
+			          << "), closing connection" << std::endl;
+			closeClient(slot->fd);
+		} else if (slot->kind == FD_CGI_STDOUT) {
+			std::cout << "  [CGI] Session timed out (stdout fd: " << slot->fd << ")" << std::endl;
+			cleanupCgiSession(slot->cgi, true);
+		}
 	}
 }
 
@@ -151,121 +259,348 @@ void Server::handleNewConnection(Socket* listenSocket) {
 	int clientPort;
 	
 	int clientFd = listenSocket->accept(clientAddr, clientPort);
+	if (clientFd < 0) {
+		return;
+	}
 	
-	if (clientFd >= 0) {
-		Client* client = _clientManager.addClient(clientFd, clientAddr, clientPort);
-		
-		// Store which port this client connected to
-		_fdToPort[clientFd] = listenSocket->getPort();
-		
-		std::cout << "New connection from " << clientAddr << ":" << clientPort 
-		          << " on port " << listenSocket->getPort()
-		          << " (fd: " << clientFd << ") - Total: " 
-		          << _clientManager.getClientCount() << std::endl;
-		(void)client;
+	if (!_shards.empty()) {
+		dispatchConnection(clientFd, clientAddr, clientPort, listenSocket->getPort());
+	} else {
+		addConnection(clientFd, clientAddr, clientPort, listenSocket->getPort());
 	}
 }
 
-// Handle client event
-void Server::handleClientEvent(const Event& event) {
-	Client* client = _clientManager.getClient(event.fd);
-	if (!client) {
+// Register an accepted connection with this event loop
+void Server::addConnection(int fd, const std::string& address, int port, int listenPort) {
+	// Level-triggered: read first (EPOLLRDHUP detects peer close). Edge-triggered:
+	// registered once for everything, readiness is tracked on the client.
+	uint32_t events = EVENT_READ | EVENT_RDHUP;
+	if (_main.getEdgeTriggered()) {
+		events |= EVENT_WRITE | EVENT_EDGE;
+	}
+	FdSlot* slot = _clientManager.addClient(fd, address, port, events);
+	
+	// Store which port this client connected to
+	slot->listenPort = listenPort;
+	
+	// Timeouts apply from the port's default server until a request is routed
+	slot->client->setServerConfig(_router.findServer("", listenPort));
+	slot->client->getTimer().data = slot;
+	armClientTimer(slot->client);
+	
+	std::cout << "New connection from " << address << ":" << port 
+	          << " on port " << listenPort
+	          << " (fd: " << fd << ") - Total: " 
+	          << _clientManager.getClientCount() << std::endl;
+}
+
+// Start the worker threads; signals stay with the main thread
+void Server::startShards() {
+	int count = _main.getWorkerThreads();
+	for (int i = 0; i < count; ++i) {
+		_shards.push_back(new Server(*this, i));
+	}
+	
+	sigset_t blocked;
+	sigset_t previous;
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	
+	for (size_t i = 0; i < _shards.size(); ++i) {
+		pthread_t thread;
+		_shards[i]->_running = true;
+		int err = pthread_create(&thread, NULL, shardMain, _shards[i]);
+		if (err != 0) {
+			pthread_sigmask(SIG_SETMASK, &previous, NULL);
+			stopShards();
+			throw std::runtime_error(std::string("Failed to start worker thread: ") + std::strerror(err));
+		}
+		_threads.push_back(thread);
+	}
+	
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	std::cout << "✓ Started " << _threads.size() << " worker threads ("
+	          << (_main.getWorkerBalance() == BALANCE_LEAST_CONN ? "least_conn" : "round_robin")
+	          << ")" << std::endl;
+}
+
+// Stop and join the worker threads
+void Server::stopShards() {
+	// Closing the write end wakes each shard's epoll_wait() at once
+	for (size_t i = 0; i < _shards.size(); ++i) {
+		_shards[i]->_running = false;
+		close(_shards[i]->_handoffPipe[1]);
+		_shards[i]->_handoffPipe[1] = -1;
+	}
+	for (size_t i = 0; i < _threads.size(); ++i) {
+		pthread_join(_threads[i], NULL);
+	}
+	_threads.clear();
+	
+	for (size_t i = 0; i < _shards.size(); ++i) {
+		delete _shards[i];
+	}
+	_shards.clear();
+}
+
+// Worker thread entry point
+void* Server::shardMain(void* arg) {
+	Server* shard = static_cast<Server*>(arg);
+	try {
+		shard->eventLoop();
+	} catch (const std::exception& e) {
+		std::cerr << "✗ Worker thread error: " << e.what() << std::endl;
+	}
+	return NULL;
+}
+
+// Pick a worker thread and pass the connection to it
+void Server::dispatchConnection(int fd, const std::string& address, int port, int listenPort) {
+	size_t index = _nextShard;
+	if (_main.getWorkerBalance() == BALANCE_LEAST_CONN) {
+		for (size_t i = 1; i < _shards.size(); ++i) {
+			if (_shards[i]->_load < _shards[index]->_load) {
+				index = i;
+			}
+		}
+	}
+	_nextShard = (index + 1) % _shards.size();
+	Server* shard = _shards[index];
+	
+	Handoff handoff;
+	std::memset(&handoff, 0, sizeof(handoff));
+	handoff.fd = fd;
+	handoff.clientPort = port;
+	handoff.listenPort = listenPort;
+	std::strncpy(handoff.address, address.c_str(), sizeof(handoff.address) - 1);
+	
+	// Smaller than PIPE_BUF, so the write is atomic
+	if (write(shard->_handoffPipe[1], &handoff, sizeof(handoff)) != static_cast<ssize_t>(sizeof(handoff))) {
+		std::cerr << "Worker thread " << index << " is saturated, dropping connection from "
+		          << address << std::endl;
+		close(fd);
 		return;
 	}
 	
+	// Counted now so a burst of accepts does not all land on one shard
+	__sync_add_and_fetch(&shard->_load, 1);
+}
+
+// Drain connections handed to this worker thread
+void Server::acceptHandoffs() {
+	Handoff handoff;
+	while (read(_handoffPipe[0], &handoff, sizeof(handoff)) == static_cast<ssize_t>(sizeof(handoff))) {
+		addConnection(handoff.fd, handoff.address, handoff.clientPort, handoff.listenPort);
+	}
+}
+
+// Handle client event
+void Server::handleClientEvent(FdSlot* slot, const Event& event) {
+	Client* client = slot->client;
+	
 	// Check for errors or disconnection
 	if (event.isError() || event.isHangup() || event.isPeerClosed()) {
 		std::cout << "Client " << client->getAddress() << " disconnected" << std::endl;
-		
-		// Check if this client has an active CGI session
-		std::map<int, int>::iterator cgiIt = _clientToCgi.find(event.fd);
-		if (cgiIt != _clientToCgi.end()) {
-			// Client disconnected while CGI is running
-			int cgiStdoutFd = cgiIt->second;
-			std::map<int, CgiSession>::iterator sessionIt = _cgiSessions.find(cgiStdoutFd);
-			if (sessionIt != _cgiSessions.end()) {
-				// Nullify the client pointer so CGI won't try to send response
-				std::cout << "  [CGI] Client disconnected during CGI execution, nullifying session client" << std::endl;
-				sessionIt->second.client = NULL;
-			}
-			_clientToCgi.erase(cgiIt);
-		}
-		
-		_fdToPort.erase(event.fd);
-		_clientManager.removeClient(event.fd);
+		closeClient(slot->fd);
 		return;
 	}
 	
-	// Handle based on client state
-	switch (client->getState()) {
-		case STATE_READING_REQUEST:
-			if (event.isReadable()) {
-				handleClientRead(client);
+	// The socket counts as writable until a write would block. Readability is
+	// the event itself (level-triggered) or kept until a read would block
+	// (edge-triggered, where events only report changes).
+	if (event.isWritable()) {
+		client->setWriteReady(true);
+	}
+	if (_main.getEdgeTriggered()) {
+		if (event.isReadable()) {
+			client->setReadReady(true);
+		}
+	} else {
+		client->setReadReady(event.isReadable());
+	}
+	
+	serviceClient(slot);
+}
+
+// Do the I/O the socket is ready for: read and answer requests, then send
+// what is queued. Responses are written right away; EPOLLOUT is only watched
+// once the socket is full. Edge-triggered mode repeats until the socket would
+// block or MAX_IO_PASSES is used up, so one busy client cannot starve the others.
+void Server::serviceClient(FdSlot* slot) {
+	Client* client = slot->client;
+	int passes = _main.getEdgeTriggered() ? MAX_IO_PASSES : 1;
+	
+	while (passes-- > 0) {
+		bool progress = false;
+		
+		if (client->isReadReady() && acceptsInput(client)) {
+			handleClientRead(client);
+			if (slot->kind != FD_CLIENT || slot->client != client) {
+				return;
 			}
-			break;
-			
-		case STATE_WRITING_RESPONSE:
-			if (event.isWritable()) {
-				handleClientWrite(client);
+			progress = true;
+		}
+		if (client->isWriteReady() && client->hasDataToWrite()) {
+			handleClientWrite(client);
+			if (slot->kind != FD_CLIENT || slot->client != client) {
+				return;
 			}
+			progress = true;
+		}
+		if (!progress) {
 			break;
-			
-		case STATE_PROCESSING:
-		case STATE_DONE:
-		case STATE_ERROR:
-			_fdToPort.erase(event.fd);
-			_clientManager.removeClient(event.fd);
-			break;
+		}
+	}
+	
+	if (!_main.getEdgeTriggered()) {
+		client->setReadReady(false);  // The next event says again
 	}
+	updateClient(client);
 }
 
-// Handle client read
-void Server::handleClientRead(Client* client) {
-	ssize_t bytesRead = client->readData();
-	
-	if (bytesRead < 0) {
-		std::cerr << "Error reading from client " << client->getFd() << std::endl;
-		_fdToPort.erase(client->getFd());
-		_clientManager.removeClient(client->getFd());
+// Continue the edge-triggered clients queued by updateClient()
+void Server::serviceReadyClients() {
+	// Clients queued while this batch runs wait for the next iteration
+	_readyBatch.swap(_readyClients);
+	for (size_t i = 0; i < _readyBatch.size(); ++i) {
+		FdSlot* slot = _fds.find(_readyBatch[i]);
+		if (slot && slot->kind == FD_CLIENT && slot->client->isReadyListed()) {
+			slot->client->setReadyListed(false);
+			serviceClient(slot);
+		}
+	}
+	_readyBatch.clear();
+}
+
+// Whether the client takes more requests now (paused while enough output is queued)
+bool Server::acceptsInput(const Client* client) const {
+	return client->getState() == STATE_READING_REQUEST &&
+	       client->getWriteBufferSize() < MAX_PIPELINE_OUTPUT;
+}
+
+// Close a client connection (detaching any CGI session still running for it)
+void Server::closeClient(int fd) {
+	FdSlot* slot = _fds.find(fd);
+	if (!slot || slot->kind != FD_CLIENT) {
 		return;
 	}
 	
-	if (bytesRead == 0) {
-		std::cout << "Client " << client->getAddress() << " closed connection" << std::endl;
-		_fdToPort.erase(client->getFd());
-		_clientManager.removeClient(client->getFd());
+	if (slot->cgi) {
+		// Nullify the client pointer so CGI won't try to send response
+		std::cout << "  [CGI] Client disconnected during CGI execution, nullifying session client" << std::endl;
+		slot->cgi->client = NULL;
+	}
+	
+	_clientManager.removeClient(fd);
+}
+
+// Change the events watched on a client connection
+void Server::watchClient(Client* client, uint32_t events) {
+	_epoll.modify(client->getFd(), events, _fds.find(client->getFd()));
+	armClientTimer(client);
+}
+
+// Watch the events the client needs next, or close it once it is done
+void Server::updateClient(Client* client) {
+	if (client->getState() == STATE_WRITING_RESPONSE && !client->hasPendingOutput()) {
+		std::cout << "Response sent to " << client->getAddress() << std::endl;
+		client->setState(STATE_DONE);
+		closeClient(client->getFd());
 		return;
 	}
 	
-	// Parse HTTP request
-	HttpRequest& request = client->getRequest();
-	size_t bytesConsumed = 0;
-	HttpParseResult result = request.parse(client->getReadBuffer(), bytesConsumed);
+	if (_main.getEdgeTriggered()) {
+		// Interest never changes; I/O the socket already allows (budget used up,
+		// or output queued outside an event, e.g. by CGI) continues next iteration
+		bool pending = (client->isWriteReady() && client->hasDataToWrite()) ||
+		               (client->isReadReady() && acceptsInput(client));
+		if (pending && !client->isReadyListed()) {
+			client->setReadyListed(true);
+			_readyClients.push_back(client->getFd());
+		}
+		armClientTimer(client);
+		return;
+	}
 	
-	if (bytesConsumed > 0) {
-		std::string& buffer = const_cast<std::string&>(client->getReadBuffer());
-		buffer.erase(0, bytesConsumed);
+	uint32_t events = EVENT_RDHUP;
+	if (client->hasDataToWrite()) {
+		events |= EVENT_WRITE;
 	}
+	// Stop reading while enough output is queued; pipelined requests wait in the socket
+	if (acceptsInput(client)) {
+		events |= EVENT_READ;
+	}
+	watchClient(client, events);
+}
+
+// Arm the client's timer with the timeout of its current phase
+void Server::armClientTimer(Client* client) {
+	const ServerConfig* server = client->getServerConfig();
+	ClientTimeout phase = TIMEOUT_NONE;
+	time_t seconds = 0;
 	
-	if (result == PARSE_FAILED) {
-		std::cerr << "Parse error from " << client->getAddress() << ": " 
-		          << request.getErrorMessage() << std::endl;
+	if (client->hasDataToWrite()) {
+		// Time between two successive writes of the response
+		phase = TIMEOUT_SEND;
+		seconds = server->getSendTimeout();
+	} else if (client->hasPendingOutput()) {
+		// Waiting for a CGI response: its own deadline applies
+		phase = TIMEOUT_NONE;
+	} else if (client->getState() == STATE_READING_REQUEST) {
+		HttpParseState parseState = client->getRequest().getState();
 		
-		Response response = Response::error(400, request.getErrorMessage());
-		response.setHeader("Server", "webserv/1.0");
-		
-		client->appendToWriteBuffer(response.build());
-		client->setState(STATE_WRITING_RESPONSE);
-		client->setKeepAlive(false);
-		_epoll.modify(client->getFd(), EVENT_WRITE | EVENT_RDHUP);
+		if (parseState == PARSE_REQUEST_LINE && client->getReadBufferSize() == 0 &&
+		    client->getRequestCount() > 0) {
+			// Idle between keep-alive requests
+			phase = TIMEOUT_KEEPALIVE;
+			seconds = server->getKeepaliveTimeout();
+		} else if (parseState == PARSE_REQUEST_LINE || parseState == PARSE_HEADERS) {
+			// Runs from the first byte: trickling headers does not extend it
+			if (client->getTimeoutPhase() == TIMEOUT_HEADER) {
+				return;
+			}
+			phase = TIMEOUT_HEADER;
+			seconds = server->getClientHeaderTimeout();
+		} else {
+			// Time between two successive reads of the body
+			phase = TIMEOUT_BODY;
+			seconds = server->getClientBodyTimeout();
+		}
+	}
+	
+	client->setTimeoutPhase(phase);
+	if (phase == TIMEOUT_NONE) {
+		_timers.cancel(&client->getTimer());
+	} else {
+		_timers.schedule(&client->getTimer(), _now + seconds);
+	}
+}
+
+// Handle client read
+void Server::handleClientRead(Client* client) {
+	// The rest of a spooled body is spliced to its file; the parser gets
+	// the request back complete (processInput() then answers it)
+	ssize_t bytesRead = client->canSpliceBody() ? client->spliceBody() : client->readData();
+	
+	if (bytesRead < 0 && !client->isReadReady()) {
+		return;  // Nothing to read (would block)
+	}
+	
+	if (bytesRead < 0) {
+		std::cerr << "Error reading from client " << client->getFd() << std::endl;
+		closeClient(client->getFd());
 		return;
 	}
 	
-	if (result == PARSE_SUCCESS) {
-		processRequest(client);
-		client->setState(STATE_WRITING_RESPONSE);
-		_epoll.modify(client->getFd(), EVENT_WRITE | EVENT_RDHUP);
+	if (bytesRead == 0) {
+		std::cout << "Client " << client->getAddress() << " closed connection" << std::endl;
+		closeClient(client->getFd());
+		return;
 	}
+	
+	processInput(client);
 }
 
 // Handle client write
@@ -274,45 +609,137 @@ void Server::handleClientWrite(Client* client) {
 	
 	if (bytesWritten < 0) {
 		std::cerr << "Error writing to client " << client->getFd() << std::endl;
-		_fdToPort.erase(client->getFd());
-		_clientManager.removeClient(client->getFd());
+		closeClient(client->getFd());
 		return;
 	}
 	
-	if (!client->hasDataToWrite()) {
-		std::cout << "Response sent to " << client->getAddress() << std::endl;
+	// Output drained: answer pipelined requests that were left buffered
+	if (client->getState() == STATE_READING_REQUEST && client->getReadBufferSize() > 0 &&
+	    client->getWriteBufferSize() < MAX_PIPELINE_OUTPUT) {
+		processInput(client);
+	}
+}
+
+// Parse and answer every complete request in the client's input, in order.
+// Each response is queued behind the previous one, so pipelined requests are
+// answered in the order they arrived.
+void Server::processInput(Client* client) {
+	while (client->getState() == STATE_READING_REQUEST) {
+		HttpRequest& request = client->getRequest();
 		
-		if (client->isKeepAlive() && client->getRequestCount() < MAX_KEEPALIVE_REQUESTS) {
-			client->incrementRequestCount();
-			client->reset();
-			_epoll.modify(client->getFd(), EVENT_READ | EVENT_RDHUP);
-		} else {
-			client->setState(STATE_DONE);
-			_fdToPort.erase(client->getFd());
-			_clientManager.removeClient(client->getFd());
+		// A request may already be complete if it waited for a CGI
+		if (request.getState() != PARSE_COMPLETE) {
+			size_t bytesConsumed = 0;
+			HttpParseResult result = request.parse(client->getReadData(),
+			                                       client->getReadBufferSize(), bytesConsumed);
+			client->consumeReadBuffer(bytesConsumed);
+			
+			if (result == PARSE_FAILED) {
+				std::cerr << "Parse error from " << client->getAddress() << ": " 
+				          << request.getErrorMessage() << std::endl;
+				
+				Response response = Response::error(request.getErrorStatus(), request.getErrorMessage());
+				response.setKeepAlive(false);
+				response.setHeader("Server", "webserv/1.0");
+				
+				queueResponse(client, response);
+				client->setKeepAlive(false);
+				client->setState(STATE_WRITING_RESPONSE);
+				return;
+			}
+			if (result == PARSE_HEADERS_DONE) {
+				prepareBody(client);
+				continue;
+			}
+			if (result == PARSE_INCOMPLETE) {
+				return;
+			}
+		}
+		
+		if (!processRequest(client)) {
+			// Second CGI on the connection: wait until the running one is done
+			client->setState(STATE_PROCESSING);
+			return;
+		}
+		
+		client->incrementRequestCount();
+		if (!client->isKeepAlive() || client->getRequestCount() > MAX_KEEPALIVE_REQUESTS) {
+			client->setState(STATE_WRITING_RESPONSE);
+			return;
+		}
+		client->reset();
+		
+		// Let the socket drain before taking more
+		if (client->getWriteBufferSize() >= MAX_PIPELINE_OUTPUT) {
+			return;
 		}
 	}
 }
 
-// Process HTTP request
-void Server::processRequest(Client* client) {
+// Route a request whose body is still to come and pick where the body goes:
+// a multipart upload is saved to its files as it arrives, a body larger than
+// client_body_buffer_size is spooled to a temporary file, and one the
+// response does not use is dropped
+void Server::prepareBody(Client* client) {
 	HttpRequest& request = client->getRequest();
-	Response response;
+	FdSlot* slot = _fds.find(client->getFd());
+	RouteResult route = _router.route(request, slot->listenPort);
+	if (!route.matched || _router.hasRedirect(*route.location)) {
+		request.setBodySink(&_discardBody);
+		return;
+	}
+	
+	// A chunked body is cut off once it outgrows the limit (0: none)
+	size_t maxBodySize = route.location->getClientMaxBodySize();
+	if (maxBodySize > 0) {
+		request.setMaxBodySize(maxBodySize);
+	}
+	
+	// Same checks processRequest makes before taking the upload branch
+	bool upload = _uploadHandler.isUploadRequest(request) &&
+	              !route.location->getUploadStore().empty();
+	if (upload) {
+		MultipartUpload* multipart = _uploadHandler.startUpload(request, route);
+		if (multipart) {
+			client->setUpload(multipart);
+			return;
+		}
+	}
+	
+	// A chunked body's size is unknown: it starts in memory and moves to
+	// the file if it outgrows the buffer
+	size_t bufferSize = route.location->getClientBodyBufferSize();
+	if (request.isChunked() || request.getContentLength() > bufferSize) {
+		size_t memoryLimit = request.isChunked() ? bufferSize : 0;
+		client->setSpool(upload ? _uploadHandler.createSpool(route, memoryLimit)
+		                        : new BodySpool(BODY_TEMP_DIR, memoryLimit));
+	}
+}
+
+// Process HTTP request and queue its response (or reserve its place for CGI).
+// Returns false, leaving the request untouched, if it is a CGI request and the
+// connection already has one running.
+bool Server::processRequest(Client* client) {
+	HttpRequest& request = client->getRequest();
+	Response response(&client->getArena());  // Gone before processInput() resets the client
 	bool keepAlive = request.isKeepAlive();
 	
 	std::cout << "Request: " << request.getMethod() << " " << request.getUri() 
 	          << " from " << client->getAddress() << std::endl;
 	
 	// Route the request
-	int listenPort = _fdToPort[client->getFd()];
-	RouteResult route = _router.route(request, listenPort);
+	FdSlot* slot = _fds.find(client->getFd());
+	RouteResult route = _router.route(request, slot->listenPort);
+	if (route.server) {
+		client->setServerConfig(route.server);
+	}
 	
 	if (!route.matched) {
 		// Routing failed - serve error page
 		std::cout << "  Route error: " << route.errorCode << " " << route.errorMessage << std::endl;
 		
 		if (route.server) {
-			FileResult errPage = _fileServer.serveErrorPage(*route.server, route.errorCode);
+			FileResult errPage = _fileServer->serveErrorPage(*route.server, route.errorCode);
 			response.setStatusCode(errPage.statusCode);
 			response.setStatusText(errPage.statusText);
 			response.setContentType(errPage.contentType);
@@ -337,7 +764,9 @@ void Server::processRequest(Client* client) {
 		    !route.location->getUploadStore().empty()) {
 			std::cout << "  File upload detected" << std::endl;
 			
-			UploadResult uploadResult = _uploadHandler.handleUpload(request, route);
+			UploadResult uploadResult = client->getUpload()
+			                            ? client->getUpload()->finish()
+			                            : _uploadHandler.handleUpload(request, route, client->getSpool());
 			
 			if (uploadResult.success) {
 				std::cout << "  Upload success: " << uploadResult.files.size() 
@@ -372,18 +801,25 @@ void Server::processRequest(Client* client) {
 			}
 			
 		} else if (_router.isCgiRequest(*route.location, route.resolvedPath)) {
+			if (slot->cgi) {
+				// One CGI per connection: retried when the running one completes
+				std::cout << "  Waiting for the connection's running CGI" << std::endl;
+				return false;
+			}
+			
 			// CGI request - start non-blocking
 			std::cout << "  CGI request detected" << std::endl;
 			std::cout << "  Resolved path: " << route.resolvedPath << std::endl;
 			
+			client->setKeepAlive(keepAlive);
 			startCgiSession(client, route);
-			return;  // Don't send response yet - will be sent when CGI completes
+			return true;  // Response is queued in its reserved place when CGI completes
 		} else if (request.getMethod() == "DELETE") {
 			// Handle DELETE request
 			std::cout << "  DELETE request detected" << std::endl;
 			std::cout << "  Resolved path: " << route.resolvedPath << std::endl;
 			
-			FileResult deleteResult = _fileServer.deleteFile(request, route);
+			FileResult deleteResult = _fileServer->deleteFile(request, route);
 			
 			if (deleteResult.success) {
 				std::cout << "  File deleted successfully" << std::endl;
@@ -396,7 +832,7 @@ void Server::processRequest(Client* client) {
 				          << " " << deleteResult.errorMessage << std::endl;
 				
 				// Try custom error page
-				FileResult errPage = _fileServer.serveErrorPage(*route.server, deleteResult.statusCode);
+				FileResult errPage = _fileServer->serveErrorPage(*route.server, deleteResult.statusCode);
 				response.setStatusCode(deleteResult.statusCode);
 				response.setStatusText(deleteResult.statusText);
 				response.setContentType(errPage.contentType);
@@ -406,107 +842,135 @@ void Server::processRequest(Client* client) {
 		} else {
 			// Serve static file
 			std::cout << "  Resolved path: " << route.resolvedPath << std::endl;
-			FileResult fileResult = _fileServer.serveFile(request, route);
+			FileResult fileResult = _fileServer->serveFile(request, route);
 			
-			if (fileResult.statusCode == 301 && !fileResult.redirectPath.empty()) {
+			if (!fileResult.cachedResponse.empty()) {
+				// Prebuilt keep-alive response - no disk access, no header building
+				std::cout << "  Serving: cached (" << fileResult.cachedResponse.size()
+				          << " bytes)" << std::endl;
+				client->appendSegment(fileResult.cachedResponse);
+				client->setKeepAlive(true);
+				return true;
+			} else if (fileResult.statusCode == 301 && !fileResult.redirectPath.empty()) {
 				// Directory redirect (add trailing slash)
 				std::cout << "  Directory redirect: " << fileResult.redirectPath << std::endl;
 				response = Response::redirect(301, fileResult.redirectPath);
+			} else if (fileResult.statusCode == 304) {
+				// Conditional GET matched - validators only, no body
+				std::cout << "  Not modified" << std::endl;
+				response.setStatusCode(304);
+				response.setStatusText(fileResult.statusText);
+				response.setHeader("ETag", fileResult.etag);
+				response.setHeader("Last-Modified", fileResult.lastModified);
 			} else if (fileResult.success) {
-				// Success - serve file
-				std::cout << "  Serving: " << fileResult.contentType 
-				          << " (" << fileResult.body.size() << " bytes)" << std::endl;
+				// Success - serve file (streamed from fd, or generated body)
+				std::cout << "  Serving: " << fileResult.contentType << " (";
+				if (fileResult.fileFd >= 0) {
+					std::cout << fileResult.fileSize;
+				} else {
+					std::cout << fileResult.body.size();
+				}
+				std::cout << " bytes)" << std::endl;
 				response.setStatusCode(fileResult.statusCode);
 				response.setStatusText(fileResult.statusText);
 				response.setContentType(fileResult.contentType);
-				response.setBody(fileResult.body);
+				if (!fileResult.ranges.empty()) {
+					response.setFileRanges(fileResult.fileFd, fileResult.ranges, fileResult.fileSize);
+				} else if (fileResult.fileFd >= 0) {
+					response.setFileBody(fileResult.fileFd, fileResult.fileSize);
+				} else {
+					response.setBody(fileResult.body);
+				}
+				if (fileResult.fileFd >= 0) {
+					response.setHeader("Accept-Ranges", "bytes");
+				}
+				if (!fileResult.etag.empty()) {
+					response.setHeader("ETag", fileResult.etag);
+					response.setHeader("Last-Modified", fileResult.lastModified);
+				}
 			} else {
 				// Error - try custom error page
 				std::cout << "  File error: " << fileResult.statusCode 
 				          << " " << fileResult.errorMessage << std::endl;
-				FileResult errPage = _fileServer.serveErrorPage(*route.server, fileResult.statusCode);
+				FileResult errPage = _fileServer->serveErrorPage(*route.server, fileResult.statusCode);
 				response.setStatusCode(fileResult.statusCode);
 				response.setStatusText(fileResult.statusText);
 				response.setContentType(errPage.contentType);
 				response.setBody(errPage.body);
-				keepAlive = false;
+				if (fileResult.statusCode == 416) {
+					// A normal answer: the client usually follows up with a plain GET
+					std::stringstream contentRange;
+					contentRange << "bytes */" << fileResult.fileSize;
+					response.setHeader("Content-Range", contentRange.str());
+				} else {
+					keepAlive = false;
+				}
 			}
 		}
 	}
 	
 	response.setKeepAlive(keepAlive);
 	response.setHeader("Server", "webserv/1.0");
-	client->appendToWriteBuffer(response.build());
+	queueResponse(client, response);
 	client->setKeepAlive(keepAlive);
+	return true;
 }
 
-// Check if fd is a listen socket
-bool Server::isListenSocket(int fd) const {
-	for (size_t i = 0; i < _listenSockets.size(); ++i) {
-		if (_listenSockets[i]->getFd() == fd) {
-			return true;
+// Queue a response on the client: header block, then the body as its own
+// segment (moved, not copied) or as file segments, all drained by writev()/sendfile()
+void Server::queueResponse(Client* client, Response& response) {
+	// Head is built in the request arena and copied into a pooled buffer
+	ArenaString head = response.buildArenaHeaders();
+	client->appendToWriteBuffer(head.data(), head.size());
+	
+	if (response.hasFileBody()) {
+		// Client streams each range with sendfile(); the last segment owns the fd
+		const Response::FilePartList& parts = response.getFileParts();
+		for (size_t i = 0; i < parts.size(); ++i) {
+			client->appendToWriteBuffer(parts[i].prefix);
+			client->appendFileSegment(response.getFileFd(), parts[i].offset, parts[i].length,
+			                          i + 1 == parts.size());
 		}
+		client->appendToWriteBuffer(response.getFileTrailer());
+		return;
 	}
-	return false;
+	
+	std::string body;
+	response.takeBody(body);
+	client->appendSegment(body);
 }
 
-// Find listen socket by fd
-Socket* Server::findListenSocket(int fd) const {
-	for (size_t i = 0; i < _listenSockets.size(); ++i) {
-		if (_listenSockets[i]->getFd() == fd) {
-			return _listenSockets[i];
-		}
-	}
-	return NULL;
-}
-// Check if fd is a CGI pipe
-bool Server::isCgiPipe(int fd) const {
-	// Check if it's a stdout fd (primary session key)
-	if (_cgiSessions.find(fd) != _cgiSessions.end()) {
-		return true;
-	}
-	// Check if it's a stdin fd
-	if (_stdinToStdout.find(fd) != _stdinToStdout.end()) {
-		return true;
-	}
-	return false;
+// Queue a late (CGI) response in the place its request reserved
+void Server::queueReservedResponse(Client* client, Response& response) {
+	client->beginReservedOutput();
+	queueResponse(client, response);
+	client->endReservedOutput();
 }
 
 // Handle CGI event (read/write on CGI pipes)
-void Server::handleCgiEvent(const Event& event) {
-	int fd = event.fd;
-	
-	// Find the session - check if this is a stdout fd or stdin fd
-	std::map<int, CgiSession>::iterator sessionIt;
-	bool isStdin = false;
-	
-	// First check if this fd is directly a session (stdout fd)
-	sessionIt = _cgiSessions.find(fd);
-	
-	// If not found, check if it's a stdin fd
-	if (sessionIt == _cgiSessions.end()) {
-		std::map<int, int>::iterator stdinIt = _stdinToStdout.find(fd);
-		if (stdinIt != _stdinToStdout.end()) {
-			// This is a stdin fd, get the corresponding stdout fd
-			int stdoutFd = stdinIt->second;
-			sessionIt = _cgiSessions.find(stdoutFd);
-			isStdin = true;
-		}
-	}
-	
-	if (sessionIt == _cgiSessions.end()) {
-		return;  // Session already cleaned up
-	}
+void Server::handleCgiEvent(FdSlot* slot, const Event& event) {
+	int fd = slot->fd;
+	bool isStdin = (slot->kind == FD_CGI_STDIN);
+	CgiSession& session = *slot->cgi;
 	
-	CgiSession& session = sessionIt->second;
-	
-	// Handle errors
+	// Handle errors. A hangup on stdout may still leave output in the pipe:
+	// it is read below until EOF.
 	if (event.isError() || event.isHangup() || event.isPeerClosed()) {
-		std::cout << "  [CGI] Error or hangup on fd " << fd << std::endl;
-		
-		// Always cleanup using stdout fd
-		finalizeCgiSession(session.stdoutFd);
-		return;
+		if (isStdin) {
+			// CGI stopped reading its input - its output still counts
+			std::cout << "  [CGI] Hangup on stdin fd " << fd << ", closing it" << std::endl;
+			_epoll.remove(session.stdinFd);
+			_fds.release(session.stdinFd);
+			close(session.stdinFd);
+			session.stdinFd = -1;
+			session.inputComplete = true;
+			return;
+		}
+		if (event.isError() || !event.isReadable()) {
+			std::cout << "  [CGI] Error or hangup on fd " << fd << std::endl;
+			finalizeCgiSession(&session);
+			return;
+		}
 	}
 	
 	// Handle stdout (reading from CGI)
@@ -520,12 +984,12 @@ void Server::handleCgiEvent(const Event& event) {
 			// Check size limit
 			if (session.outputBuffer.size() > 10 * 1024 * 1024) {  // 10MB
 				std::cout << "  [CGI] Output too large" << std::endl;
-				cleanupCgiSession(session.stdoutFd, true);
+				cleanupCgiSession(&session, true);
 			}
 		} else if (bytesRead == 0) {
 			// EOF - CGI finished
 			std::cout << "  [CGI] EOF on stdout" << std::endl;
-			finalizeCgiSession(session.stdoutFd);
+			finalizeCgiSession(&session);
 		}
 		// bytesRead < 0: EAGAIN/EWOULDBLOCK or error
 		// Errors are handled by event.isError() above
@@ -547,11 +1011,9 @@ void Server::handleCgiEvent(const Event& event) {
 					session.inputComplete = true;
 					
 					// Close stdin to signal EOF to CGI
-					close(session.stdinFd);
 					_epoll.remove(session.stdinFd);
-					
-					// Remove from helper map
-					_stdinToStdout.erase(session.stdinFd);
+					_fds.release(session.stdinFd);
+					close(session.stdinFd);
 					
 					// Mark stdin as closed in session
 					session.stdinFd = -1;
@@ -565,13 +1027,8 @@ void Server::handleCgiEvent(const Event& event) {
 }
 
 // Finalize CGI session (parse output and send response)
-void Server::finalizeCgiSession(int cgiFd) {
-	std::map<int, CgiSession>::iterator it = _cgiSessions.find(cgiFd);
-	if (it == _cgiSessions.end()) {
-		return;
-	}
-	
-	CgiSession& session = it->second;
+void Server::finalizeCgiSession(CgiSession* sessionPtr) {
+	CgiSession& session = *sessionPtr;
 	Client* client = session.client;
 	
 	std::cout << "  [CGI] Finalizing session (output: " 
@@ -590,7 +1047,7 @@ void Server::finalizeCgiSession(int cgiFd) {
 	// Check if client is still connected
 	if (!client) {
 		std::cout << "  [CGI] Client disconnected, discarding CGI output" << std::endl;
-		cleanupCgiSession(cgiFd, false);
+		cleanupCgiSession(sessionPtr, false);
 		return;
 	}
 	
@@ -603,92 +1060,84 @@ void Server::finalizeCgiSession(int cgiFd) {
 	if (!_cgiHandler.parseCgiOutput(session.outputBuffer, headers, body, 
 	                                 statusCode, statusText)) {
 		std::cout << "  [CGI] Failed to parse output" << std::endl;
-		Response response = Response::error(502, "Bad Gateway: Failed to parse CGI output");
-		response.setHeader("Server", "webserv/1.0");
-		client->appendToWriteBuffer(response.build());
-		client->setState(STATE_WRITING_RESPONSE);
-		client->setKeepAlive(false);
-		_epoll.modify(client->getFd(), EVENT_WRITE | EVENT_RDHUP);
-		cleanupCgiSession(cgiFd, false);
+		{
+			Response response = Response::error(502, "Bad Gateway: Failed to parse CGI output");
+			response.setKeepAlive(session.keepAlive);
+			response.setHeader("Server", "webserv/1.0");
+			queueReservedResponse(client, response);
+		}
+		cleanupCgiSession(sessionPtr, false);
 		return;
 	}
 	
-	// Build response
-	Response response;
-	response.setStatusCode(statusCode);
-	response.setStatusText(statusText);
-	response.setBody(body);
-	
-	// Set content type
-	std::map<std::string, std::string>::iterator ctIt = headers.find("Content-Type");
-	if (ctIt != headers.end()) {
-		response.setContentType(ctIt->second);
-	} else {
-		response.setContentType("text/html");
-	}
-	
-	// Add other headers
-	for (std::map<std::string, std::string>::iterator it = headers.begin();
-	     it != headers.end(); ++it) {
-		if (it->first != "Content-Type") {
-			response.setHeader(it->first, it->second);
+	// Build response. It is gone before cleanupCgiSession(), which may go on
+	// to reset or close the client (so it is not from the client's arena either)
+	{
+		Response response;
+		response.setStatusCode(statusCode);
+		response.setStatusText(statusText);
+		size_t bodySize = body.size();
+		response.swapBody(body);  // Leaves body empty
+		
+		// Set content type
+		std::map<std::string, std::string>::iterator ctIt = headers.find("Content-Type");
+		if (ctIt != headers.end()) {
+			response.setContentType(ctIt->second);
+		} else {
+			response.setContentType("text/html");
+		}
+		
+		// Add other headers
+		for (std::map<std::string, std::string>::iterator it = headers.begin();
+		     it != headers.end(); ++it) {
+			if (it->first != "Content-Type") {
+				response.setHeader(it->first, it->second);
+			}
 		}
+		
+		response.setKeepAlive(session.keepAlive);
+		response.setHeader("Server", "webserv/1.0");
+		
+		std::cout << "  [CGI] Sending response: " << statusCode << " " << statusText 
+		          << " (" << bodySize << " bytes)" << std::endl;
+		
+		// Send response to client, in the place its request reserved
+		queueReservedResponse(client, response);
 	}
 	
-	response.setKeepAlive(client->isKeepAlive());
-	response.setHeader("Server", "webserv/1.0");
-	
-	std::cout << "  [CGI] Sending response: " << statusCode << " " << statusText 
-	          << " (" << body.size() << " bytes)" << std::endl;
-	
-	// Send response to client
-	client->appendToWriteBuffer(response.build());
-	client->setState(STATE_WRITING_RESPONSE);
-	_epoll.modify(client->getFd(), EVENT_WRITE | EVENT_RDHUP);
-	
 	// Cleanup CGI session
-	cleanupCgiSession(cgiFd, false);
+	cleanupCgiSession(sessionPtr, false);
 }
 
 // Cleanup CGI session
-void Server::cleanupCgiSession(int cgiFd, bool sendError) {
-	std::map<int, CgiSession>::iterator it = _cgiSessions.find(cgiFd);
-	if (it == _cgiSessions.end()) {
-		return;
-	}
-	
-	CgiSession& session = it->second;
+void Server::cleanupCgiSession(CgiSession* sessionPtr, bool sendError) {
+	CgiSession& session = *sessionPtr;
 	Client* client = session.client;
 	
-	std::cout << "  [CGI] Cleaning up session (fd: " << cgiFd << ")" << std::endl;
+	std::cout << "  [CGI] Cleaning up session (fd: " << session.stdoutFd << ")" << std::endl;
 	
 	// Send error response if requested
 	if (sendError && client) {
 		Response response = Response::error(502, "Bad Gateway: CGI execution failed");
+		response.setKeepAlive(session.keepAlive);
 		response.setHeader("Server", "webserv/1.0");
-		client->appendToWriteBuffer(response.build());
-		client->setState(STATE_WRITING_RESPONSE);
-		client->setKeepAlive(false);
-		_epoll.modify(client->getFd(), EVENT_WRITE | EVENT_RDHUP);
+		queueReservedResponse(client, response);
 	}
 	
-	// Remove client->CGI mapping if client is still valid
+	// Detach from the client if it is still connected
 	if (client) {
-		_clientToCgi.erase(client->getFd());
-	}
-	
-	// Remove stdin from helper map if it exists
-	if (session.stdinFd >= 0) {
-		_stdinToStdout.erase(session.stdinFd);
+		_fds.find(client->getFd())->cgi = NULL;
 	}
 	
-	// Remove pipes from epoll and close them
+	// Remove pipes from epoll, free their slots and close them
 	if (session.stdoutFd >= 0) {
 		_epoll.remove(session.stdoutFd);
+		_fds.release(session.stdoutFd);
 		close(session.stdoutFd);
 	}
 	if (session.stdinFd >= 0) {
 		_epoll.remove(session.stdinFd);
+		_fds.release(session.stdinFd);
 		close(session.stdinFd);
 	}
 	
@@ -698,92 +1147,100 @@ void Server::cleanupCgiSession(int cgiFd, bool sendError) {
 		waitpid(session.pid, NULL, 0);
 	}
 	
-	// Remove session
-	_cgiSessions.erase(it);
-}
-
-// Check CGI timeouts
-void Server::checkCgiTimeouts() {
-	time_t now = std::time(NULL);
-	std::vector<int> timedOut;
+	delete sessionPtr;
 	
-	// Iterate over sessions (keyed by stdout fd)
-	for (std::map<int, CgiSession>::iterator it = _cgiSessions.begin();
-	     it != _cgiSessions.end(); ++it) {
-		if (now - it->second.startTime > 30) {  // 30 second timeout
-			std::cout << "  [CGI] Session timed out (stdout fd: " << it->first << ")" << std::endl;
-			timedOut.push_back(it->first);
+	if (client) {
+		// Take the pipelined request that waited for this CGI, if any
+		if (client->getState() == STATE_PROCESSING) {
+			client->setState(STATE_READING_REQUEST);
+			processInput(client);
 		}
-	}
-	
-	for (size_t i = 0; i < timedOut.size(); ++i) {
-		cleanupCgiSession(timedOut[i], true);
+		serviceClient(_fds.find(client->getFd()));  // Send the response now if the socket allows
 	}
 }
 
 // Start CGI session (non-blocking)
 void Server::startCgiSession(Client* client, const RouteResult& route) {
-	int listenPort = _fdToPort[client->getFd()];
+	int listenPort = _fds.find(client->getFd())->listenPort;
 	HttpRequest& request = client->getRequest();
 	
+	// A spooled body is the script's stdin as is; others are written to a pipe
+	BodySpool* spool = client->getSpool();
+	int bodyFd = (spool && spool->isFile()) ? spool->getFd() : -1;
+	
 	// Start CGI process
-	CgiStartResult result = _cgiHandler.startNonBlocking(
-		request, route,
-		client->getAddress(),
-		client->getPort(),
-		listenPort
-	);
+	CgiStartResult result;
+	if (spool && spool->hasFailed()) {
+		result.errorMessage = "Failed to spool request body";
+		result.errorCode = 500;
+	} else {
+		result = _cgiHandler.startNonBlocking(
+			request, route,
+			client->getAddress(),
+			client->getPort(),
+			listenPort,
+			bodyFd
+		);
+	}
 	
 	if (!result.success) {
 		// Failed to start CGI
 		std::cout << "  [CGI] Failed to start: " << result.errorMessage << std::endl;
 		
 		Response response = Response::error(result.errorCode, result.errorMessage);
+		response.setKeepAlive(false);
 		response.setHeader("Server", "webserv/1.0");
-		client->appendToWriteBuffer(response.build());
-		client->setState(STATE_WRITING_RESPONSE);
+		queueResponse(client, response);
 		client->setKeepAlive(false);
-		_epoll.modify(client->getFd(), EVENT_WRITE | EVENT_RDHUP);
 		return;
 	}
 	
 	// Create CGI session
-	CgiSession session;
+	CgiSession* sessionPtr = new CgiSession();
+	CgiSession& session = *sessionPtr;
 	session.client = client;
 	session.pid = result.pid;
 	session.stdoutFd = result.stdoutFd;
 	session.stdinFd = result.stdinFd;
 	session.startTime = std::time(NULL);
-	session.inputBuffer = request.getBody();
+	if (bodyFd < 0) {
+		session.inputBuffer = spool ? spool->getData() : request.getBody();
+	}
 	session.inputSent = 0;
-	session.inputComplete = request.getBody().empty();
+	session.inputComplete = session.inputBuffer.empty();
 	session.route = route;
 	session.requestMethod = request.getMethod();
 	session.requestUri = request.getUri();
 	session.clientIp = client->getAddress();
 	session.clientPort = client->getPort();
 	session.serverPort = listenPort;
+	session.keepAlive = client->isKeepAlive();
+	
+	// Add stdout to epoll for reading; its slot points at the session
+	FdSlot* stdoutSlot = _fds.acquire(session.stdoutFd, FD_CGI_STDOUT);
+	stdoutSlot->cgi = sessionPtr;
+	_epoll.add(session.stdoutFd, EVENT_READ, stdoutSlot);
 	
-	// Add stdout to epoll for reading and store session (keyed by stdout fd)
-	_epoll.add(session.stdoutFd, EVENT_READ);
-	_cgiSessions[session.stdoutFd] = session;
+	// Killed with a 502 if it runs too long
+	session.timer.data = stdoutSlot;
+	_timers.schedule(&session.timer, _now + _cgiHandler.getTimeout());
 	
-	// Map client fd to CGI stdout fd (for cleanup when client disconnects)
-	_clientToCgi[client->getFd()] = session.stdoutFd;
+	// Link the client to its session (for cleanup when client disconnects)
+	_fds.find(client->getFd())->cgi = sessionPtr;
 	
 	// If we have input to send, add stdin to epoll for writing
 	if (!session.inputComplete) {
-		_epoll.add(session.stdinFd, EVENT_WRITE);
-		// Map stdin fd to stdout fd (for lookup in handleCgiEvent)
-		_stdinToStdout[session.stdinFd] = session.stdoutFd;
-	} else {
+		FdSlot* stdinSlot = _fds.acquire(session.stdinFd, FD_CGI_STDIN);
+		stdinSlot->cgi = sessionPtr;
+		_epoll.add(session.stdinFd, EVENT_WRITE, stdinSlot);
+	} else if (session.stdinFd >= 0) {
 		// No input - close stdin immediately
 		close(session.stdinFd);
-		_cgiSessions[session.stdoutFd].stdinFd = -1;
+		session.stdinFd = -1;
 	}
 	
-	// Set client to processing state
-	client->setState(STATE_PROCESSING);
+	// Hold the response's place; later pipelined responses queue behind it
+	client->reserveOutput();
 	
 	std::cout << "  [CGI] Session started (stdout: " << session.stdoutFd 
 	          << ", stdin: " << session.stdinFd << ")" << std::endl;
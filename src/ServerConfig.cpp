@@ -7,9 +7,27 @@
 ServerConfig::ServerConfig()
 	: _autoindex(false),
 	  _client_max_body_size(0),
+	  _client_body_buffer_size(0),
+	  _open_file_cache(0),
+	  _open_file_cache_valid(0),
+	  _file_cache_size(0),
+	  _file_cache_max_entry(0),
+	  _client_header_timeout(0),
+	  _client_body_timeout(0),
+	  _keepalive_timeout(0),
+	  _send_timeout(0),
 	  _root_set(false),
 	  _autoindex_set(false),
-	  _client_max_body_size_set(false) {}
+	  _client_max_body_size_set(false),
+	  _client_body_buffer_size_set(false),
+	  _open_file_cache_set(false),
+	  _open_file_cache_valid_set(false),
+	  _file_cache_size_set(false),
+	  _file_cache_max_entry_set(false),
+	  _client_header_timeout_set(false),
+	  _client_body_timeout_set(false),
+	  _keepalive_timeout_set(false),
+	  _send_timeout_set(false) {}
 
 // Copy constructor
 ServerConfig::ServerConfig(const ServerConfig& other)
@@ -20,10 +38,28 @@ ServerConfig::ServerConfig(const ServerConfig& other)
 	  _index(other._index),
 	  _autoindex(other._autoindex),
 	  _client_max_body_size(other._client_max_body_size),
+	  _client_body_buffer_size(other._client_body_buffer_size),
+	  _open_file_cache(other._open_file_cache),
+	  _open_file_cache_valid(other._open_file_cache_valid),
+	  _file_cache_size(other._file_cache_size),
+	  _file_cache_max_entry(other._file_cache_max_entry),
+	  _client_header_timeout(other._client_header_timeout),
+	  _client_body_timeout(other._client_body_timeout),
+	  _keepalive_timeout(other._keepalive_timeout),
+	  _send_timeout(other._send_timeout),
 	  _locations(other._locations),
 	  _root_set(other._root_set),
 	  _autoindex_set(other._autoindex_set),
 	  _client_max_body_size_set(other._client_max_body_size_set),
+	  _client_body_buffer_size_set(other._client_body_buffer_size_set),
+	  _open_file_cache_set(other._open_file_cache_set),
+	  _open_file_cache_valid_set(other._open_file_cache_valid_set),
+	  _file_cache_size_set(other._file_cache_size_set),
+	  _file_cache_max_entry_set(other._file_cache_max_entry_set),
+	  _client_header_timeout_set(other._client_header_timeout_set),
+	  _client_body_timeout_set(other._client_body_timeout_set),
+	  _keepalive_timeout_set(other._keepalive_timeout_set),
+	  _send_timeout_set(other._send_timeout_set),
 	  _seen_listen(other._seen_listen),
 	  _seen_server_names(other._seen_server_names),
 	  _seen_index(other._seen_index),
@@ -40,10 +76,28 @@ ServerConfig& ServerConfig::operator=(const ServerConfig& rhs) {
 		_index = rhs._index;
 		_autoindex = rhs._autoindex;
 		_client_max_body_size = rhs._client_max_body_size;
+		_client_body_buffer_size = rhs._client_body_buffer_size;
+		_open_file_cache = rhs._open_file_cache;
+		_open_file_cache_valid = rhs._open_file_cache_valid;
+		_file_cache_size = rhs._file_cache_size;
+		_file_cache_max_entry = rhs._file_cache_max_entry;
+		_client_header_timeout = rhs._client_header_timeout;
+		_client_body_timeout = rhs._client_body_timeout;
+		_keepalive_timeout = rhs._keepalive_timeout;
+		_send_timeout = rhs._send_timeout;
 		_locations = rhs._locations;
 		_root_set = rhs._root_set;
 		_autoindex_set = rhs._autoindex_set;
 		_client_max_body_size_set = rhs._client_max_body_size_set;
+		_client_body_buffer_size_set = rhs._client_body_buffer_size_set;
+		_open_file_cache_set = rhs._open_file_cache_set;
+		_open_file_cache_valid_set = rhs._open_file_cache_valid_set;
+		_file_cache_size_set = rhs._file_cache_size_set;
+		_file_cache_max_entry_set = rhs._file_cache_max_entry_set;
+		_client_header_timeout_set = rhs._client_header_timeout_set;
+		_client_body_timeout_set = rhs._client_body_timeout_set;
+		_keepalive_timeout_set = rhs._keepalive_timeout_set;
+		_send_timeout_set = rhs._send_timeout_set;
 		_seen_listen = rhs._seen_listen;
 		_seen_server_names = rhs._seen_server_names;
 		_seen_index = rhs._seen_index;
@@ -118,6 +172,73 @@ void ServerConfig::setClientMaxBodySize(size_t size) {
 	_client_max_body_size_set = true;
 }
 
+void ServerConfig::setClientBodyBufferSize(size_t size) {
+	if (_client_body_buffer_size_set)
+		throw std::runtime_error("Duplicate 'client_body_buffer_size' directive in server block");
+	if (size > (1024 * 1024 * 1024))
+		throw std::runtime_error("'client_body_buffer_size' cannot exceed 1024M");
+	_client_body_buffer_size = size;
+	_client_body_buffer_size_set = true;
+}
+
+// Setters - Server-level file cache directives
+void ServerConfig::setOpenFileCache(size_t maxEntries) {
+	if (_open_file_cache_set)
+		throw std::runtime_error("Duplicate 'open_file_cache' directive in server block");
+	_open_file_cache = maxEntries;
+	_open_file_cache_set = true;
+}
+
+void ServerConfig::setOpenFileCacheValid(time_t seconds) {
+	if (_open_file_cache_valid_set)
+		throw std::runtime_error("Duplicate 'open_file_cache_valid' directive in server block");
+	_open_file_cache_valid = seconds;
+	_open_file_cache_valid_set = true;
+}
+
+void ServerConfig::setFileCacheSize(size_t bytes) {
+	if (_file_cache_size_set)
+		throw std::runtime_error("Duplicate 'file_cache_size' directive in server block");
+	_file_cache_size = bytes;
+	_file_cache_size_set = true;
+}
+
+void ServerConfig::setFileCacheMaxEntry(size_t bytes) {
+	if (_file_cache_max_entry_set)
+		throw std::runtime_error("Duplicate 'file_cache_max_entry' directive in server block");
+	_file_cache_max_entry = bytes;
+	_file_cache_max_entry_set = true;
+}
+
+// Setters - Server-level connection timeouts
+void ServerConfig::setClientHeaderTimeout(time_t seconds) {
+	if (_client_header_timeout_set)
+		throw std::runtime_error("Duplicate 'client_header_timeout' directive in server block");
+	_client_header_timeout = seconds;
+	_client_header_timeout_set = true;
+}
+
+void ServerConfig::setClientBodyTimeout(time_t seconds) {
+	if (_client_body_timeout_set)
+		throw std::runtime_error("Duplicate 'client_body_timeout' directive in server block");
+	_client_body_timeout = seconds;
+	_client_body_timeout_set = true;
+}
+
+void ServerConfig::setKeepaliveTimeout(time_t seconds) {
+	if (_keepalive_timeout_set)
+		throw std::runtime_error("Duplicate 'keepalive_timeout' directive in server block");
+	_keepalive_timeout = seconds;
+	_keepalive_timeout_set = true;
+}
+
+void ServerConfig::setSendTimeout(time_t seconds) {
+	if (_send_timeout_set)
+		throw std::runtime_error("Duplicate 'send_timeout' directive in server block");
+	_send_timeout = seconds;
+	_send_timeout_set = true;
+}
+
 // Getters
 const std::vector<ListenAddress>& ServerConfig::getListenAddresses() const { 
 	return _listen_addresses; 
@@ -139,12 +260,30 @@ const std::string& ServerConfig::getRoot() const { return _root; }
 const std::vector<std::string>& ServerConfig::getIndex() const { return _index; }
 bool ServerConfig::getAutoIndex() const { return _autoindex; }
 size_t ServerConfig::getClientMaxBodySize() const { return _client_max_body_size; }
+size_t ServerConfig::getClientBodyBufferSize() const { return _client_body_buffer_size; }
+size_t ServerConfig::getOpenFileCache() const { return _open_file_cache; }
+time_t ServerConfig::getOpenFileCacheValid() const { return _open_file_cache_valid; }
+size_t ServerConfig::getFileCacheSize() const { return _file_cache_size; }
+size_t ServerConfig::getFileCacheMaxEntry() const { return _file_cache_max_entry; }
+time_t ServerConfig::getClientHeaderTimeout() const { return _client_header_timeout; }
+time_t ServerConfig::getClientBodyTimeout() const { return _client_body_timeout; }
+time_t ServerConfig::getKeepaliveTimeout() const { return _keepalive_timeout; }
+time_t ServerConfig::getSendTimeout() const { return _send_timeout; }
 
 // Presence checks
 bool ServerConfig::hasRoot() const { return _root_set; }
 bool ServerConfig::hasIndex() const { return !_index.empty(); }
 bool ServerConfig::hasAutoIndex() const { return _autoindex_set; }
 bool ServerConfig::hasClientMaxBodySize() const { return _client_max_body_size_set; }
+bool ServerConfig::hasClientBodyBufferSize() const { return _client_body_buffer_size_set; }
+bool ServerConfig::hasOpenFileCache() const { return _open_file_cache_set; }
+bool ServerConfig::hasOpenFileCacheValid() const { return _open_file_cache_valid_set; }
+bool ServerConfig::hasFileCacheSize() const { return _file_cache_size_set; }
+bool ServerConfig::hasFileCacheMaxEntry() const { return _file_cache_max_entry_set; }
+bool ServerConfig::hasClientHeaderTimeout() const { return _client_header_timeout_set; }
+bool ServerConfig::hasClientBodyTimeout() const { return _client_body_timeout_set; }
+bool ServerConfig::hasKeepaliveTimeout() const { return _keepalive_timeout_set; }
+bool ServerConfig::hasSendTimeout() const { return _send_timeout_set; }
 
 // Create a "parent" LocationConfig for inheritance
 LocationConfig ServerConfig::createParentConfig() const {
@@ -163,6 +302,9 @@ LocationConfig ServerConfig::createParentConfig() const {
 	if (_client_max_body_size_set)
 		parent.setClientMaxBodySize(_client_max_body_size);
 	
+	if (_client_body_buffer_size_set)
+		parent.setClientBodyBufferSize(_client_body_buffer_size);
+	
 	return parent;
 }
 
@@ -112,7 +112,8 @@ int Socket::accept(std::string& clientAddr, int& clientPort) {
 	struct sockaddr_in addr;
 	socklen_t addrLen = sizeof(addr);
 	
-	int clientFd = ::accept(_fd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen);
+	// Close-on-exec: CGI children must not keep client connections open
+	int clientFd = ::accept4(_fd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen, SOCK_CLOEXEC);
 	
 	if (clientFd < 0) {
 		// EAGAIN/EWOULDBLOCK means no pending connections (non-blocking mode)
@@ -152,6 +153,20 @@ void Socket::setReuseAddr(bool enable) {
 	}
 }
 
+// Set SO_REUSEPORT option
+void Socket::setReusePort(bool enable) {
+	if (_fd < 0 || _closed) {
+		throw SocketError("Cannot set option: socket is closed");
+	}
+	
+	int optval = enable ? 1 : 0;
+	// Several sockets may bind the same address:port; the kernel spreads
+	// incoming connections across the listening ones
+	if (::setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+		throw SocketError("Failed to set SO_REUSEPORT", errno);
+	}
+}
+
 // Set non-blocking mode
 void Socket::setNonBlocking(bool enable) {
 	if (_fd < 0 || _closed) {
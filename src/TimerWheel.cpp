@@ -0,0 +1,87 @@
+#include "TimerWheel.hpp"
+
+// Constructor
+TimerWheel::TimerWheel()
+	: _current(now()) {
+	for (size_t i = 0; i < SLOTS; ++i) {
+		_slots[i].prev = &_slots[i];
+		_slots[i].next = &_slots[i];
+	}
+}
+
+// Destructor - leaves remaining timers unlinked
+TimerWheel::~TimerWheel() {
+	for (size_t i = 0; i < SLOTS; ++i) {
+		while (_slots[i].next != &_slots[i]) {
+			_slots[i].next->unlink();
+		}
+		_slots[i].prev = NULL;
+		_slots[i].next = NULL;
+	}
+}
+
+// Arm (or re-arm) node to fire at deadline
+void TimerWheel::schedule(TimerNode* node, time_t deadline) {
+	node->unlink();
+	
+	// Already due: fire on the next expiry pass
+	if (deadline < _current) {
+		deadline = _current;
+	}
+	node->deadline = deadline;
+	
+	TimerNode& head = _slots[static_cast<size_t>(deadline) % SLOTS];
+	node->prev = head.prev;
+	node->next = &head;
+	head.prev->next = node;
+	head.prev = node;
+}
+
+// Disarm node
+void TimerWheel::cancel(TimerNode* node) {
+	node->unlink();
+}
+
+// Unlink and return one timer due at now, or NULL when none is left
+TimerNode* TimerWheel::popExpired(time_t now) {
+	for (size_t steps = 0; _current <= now && steps < SLOTS; ++steps) {
+		TimerNode& head = _slots[static_cast<size_t>(_current) % SLOTS];
+		for (TimerNode* node = head.next; node != &head; node = node->next) {
+			if (node->deadline <= now) {
+				node->unlink();
+				return node;
+			}
+		}
+		++_current;
+	}
+	
+	// A full round without a due timer: nothing older than now is left
+	if (_current <= now) {
+		_current = now + 1;
+	}
+	return NULL;
+}
+
+// Milliseconds until the earliest armed slot is due (-1 if no timer is armed)
+int TimerWheel::nextTimeout(long long nowMs) const {
+	for (size_t i = 0; i < SLOTS; ++i) {
+		time_t second = _current + static_cast<time_t>(i);
+		const TimerNode& head = _slots[static_cast<size_t>(second) % SLOTS];
+		if (head.next != &head) {
+			long long wait = static_cast<long long>(second) * 1000 - nowMs;
+			return wait > 0 ? static_cast<int>(wait) : 0;
+		}
+	}
+	return -1;
+}
+
+// Monotonic clock
+long long TimerWheel::nowMs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<long long>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+time_t TimerWheel::now() {
+	return static_cast<time_t>(nowMs() / 1000);
+}
@@ -1,7 +1,8 @@
 #include "UploadHandler.hpp"
-#include <fstream>
 #include <sstream>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <ctime>
 #include <cstdlib>
 #include <cerrno>
@@ -22,7 +23,7 @@ bool UploadHandler::isUploadRequest(const HttpRequest& request) const {
 	}
 	
 	// Check for multipart/form-data or application content types
-	std::string contentType = request.getHeader("Content-Type");
+	const std::string& contentType = request.getHeader(HEADER_CONTENT_TYPE);
 	if (contentType.empty()) {
 		return false;
 	}
@@ -39,7 +40,7 @@ bool UploadHandler::isUploadRequest(const HttpRequest& request) const {
 
 // Check if request is multipart/form-data
 bool UploadHandler::isMultipartRequest(const HttpRequest& request) const {
-	std::string contentType = request.getHeader("Content-Type");
+	const std::string& contentType = request.getHeader(HEADER_CONTENT_TYPE);
 	std::string lowerCT = contentType;
 	for (size_t i = 0; i < lowerCT.size(); ++i) {
 		lowerCT[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(lowerCT[i])));
@@ -171,88 +172,6 @@ bool UploadHandler::parsePartHeaders(const std::string& headerSection,
 	return true;
 }
 
-// Parse multipart/form-data body
-bool UploadHandler::parseMultipart(const std::string& body,
-                                    const std::string& boundary,
-                                    std::vector<MultipartPart>& parts) {
-	parts.clear();
-	
-	if (boundary.empty()) {
-		return false;
-	}
-	
-	// Boundary markers
-	std::string delimiter = "--" + boundary;
-	std::string endDelimiter = "--" + boundary + "--";
-	
-	// Find first boundary
-	size_t pos = body.find(delimiter);
-	if (pos == std::string::npos) {
-		return false;
-	}
-	
-	// Skip past first boundary and CRLF
-	pos += delimiter.size();
-	if (pos < body.size() && body[pos] == '\r') pos++;
-	if (pos < body.size() && body[pos] == '\n') pos++;
-	
-	while (pos < body.size() && parts.size() < MAX_FILES_PER_UPLOAD) {
-		// Find next boundary
-		size_t nextBoundary = body.find(delimiter, pos);
-		if (nextBoundary == std::string::npos) {
-			break;
-		}
-		
-		// Extract part content (without trailing CRLF before boundary)
-		std::string partContent = body.substr(pos, nextBoundary - pos);
-		
-		// Remove trailing CRLF
-		if (partContent.size() >= 2 && 
-		    partContent[partContent.size() - 2] == '\r' && 
-		    partContent[partContent.size() - 1] == '\n') {
-			partContent = partContent.substr(0, partContent.size() - 2);
-		}
-		
-		// Split headers and body
-		size_t headerEnd = partContent.find("\r\n\r\n");
-		if (headerEnd == std::string::npos) {
-			headerEnd = partContent.find("\n\n");
-			if (headerEnd == std::string::npos) {
-				// Malformed part
-				pos = nextBoundary + delimiter.size();
-				continue;
-			}
-		}
-		
-		std::string headerSection = partContent.substr(0, headerEnd);
-		size_t bodyStart = headerEnd + (partContent[headerEnd] == '\r' ? 4 : 2);
-		std::string partBody = (bodyStart < partContent.size()) 
-		                        ? partContent.substr(bodyStart) 
-		                        : "";
-		
-		// Parse part
-		MultipartPart part;
-		if (parsePartHeaders(headerSection, part)) {
-			part.data = partBody;
-			parts.push_back(part);
-		}
-		
-		// Move to next part
-		pos = nextBoundary + delimiter.size();
-		
-		// Check for end delimiter
-		if (pos + 2 <= body.size() && body.substr(pos, 2) == "--") {
-			break;  // End of multipart
-		}
-		
-		// Skip CRLF after boundary
-		if (pos < body.size() && body[pos] == '\r') pos++;
-		if (pos < body.size() && body[pos] == '\n') pos++;
-	}
-	
-	return !parts.empty();
-}
-
 // Sanitize filename
 std::string UploadHandler::sanitizeFilename(const std::string& filename) const {
 	if (filename.empty()) {
@@ -382,15 +301,14 @@ bool UploadHandler::ensureDirectory(const std::string& path) const {
 	return false;
 }
 
-// Save file to disk
-bool UploadHandler::saveFile(const std::string& uploadDir,
+// Create a new upload file
+int UploadHandler::createFile(const std::string& uploadDir,
                               const std::string& filename,
-                              const std::string& data,
                               std::string& savedPath) {
 	// Ensure upload directory exists
 	if (!ensureDirectory(uploadDir)) {
 		if (!isWritableDirectory(uploadDir)) {
-			return false;
+			return -1;
 		}
 	}
 	
@@ -404,20 +322,61 @@ bool UploadHandler::saveFile(const std::string& uploadDir,
 	}
 	savedPath += uniqueName;
 	
-	// Write file
-	std::ofstream file(savedPath.c_str(), std::ios::binary);
-	if (!file) {
+	return open(savedPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+}
+
+// Write all of data to a file
+static bool writeAll(int fd, const char* data, size_t size) {
+	while (size > 0) {
+		ssize_t written = ::write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+// Save file to disk
+bool UploadHandler::saveFile(const std::string& uploadDir,
+                              const std::string& filename,
+                              const std::string& data,
+                              std::string& savedPath) {
+	int fd = createFile(uploadDir, filename, savedPath);
+	if (fd < 0) {
 		return false;
 	}
 	
-	file.write(data.c_str(), data.size());
-	
-	return file.good();
+	bool written = writeAll(fd, data.data(), data.size());
+	if (::close(fd) != 0 || !written) {
+		unlink(savedPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+// Upload directory of the route
+std::string UploadHandler::getUploadDir(const RouteResult& route) const {
+	std::string uploadDir = route.location->getUploadStore();
+	if (uploadDir.empty()) {
+		// Use root + location path as fallback
+		uploadDir = route.location->getRoot();
+		if (!uploadDir.empty() && uploadDir[uploadDir.size() - 1] != '/') {
+			uploadDir += '/';
+		}
+		uploadDir += "uploads";
+	}
+	return uploadDir;
 }
 
 // Handle file upload
 UploadResult UploadHandler::handleUpload(const HttpRequest& request,
-                                          const RouteResult& route) {
+                                          const RouteResult& route,
+                                          BodySpool* spool) {
 	UploadResult result;
 	
 	// Validate route
@@ -429,15 +388,7 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 	}
 	
 	// Get upload directory
-	std::string uploadDir = route.location->getUploadStore();
-	if (uploadDir.empty()) {
-		// Use root + location path as fallback
-		uploadDir = route.location->getRoot();
-		if (!uploadDir.empty() && uploadDir[uploadDir.size() - 1] != '/') {
-			uploadDir += '/';
-		}
-		uploadDir += "uploads";
-	}
+	std::string uploadDir = getUploadDir(route);
 	
 	// Check request method
 	if (request.getMethod() != "POST") {
@@ -448,7 +399,7 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 	}
 	
 	// Check content type
-	std::string contentType = request.getHeader("Content-Type");
+	const std::string& contentType = request.getHeader(HEADER_CONTENT_TYPE);
 	if (contentType.empty()) {
 		result.statusCode = 400;
 		result.statusText = "Bad Request";
@@ -466,68 +417,15 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 			return result;
 		}
 		
-		// Parse multipart body
-		std::vector<MultipartPart> parts;
-		if (!parseMultipart(request.getBody(), boundary, parts)) {
-			result.statusCode = 400;
-			result.statusText = "Bad Request";
-			result.errorMessage = "Failed to parse multipart body";
-			return result;
-		}
-
-		for (size_t i = 0; i < parts.size(); ++i){
-			// Check body size
-			size_t maxBodySize = route.location->getClientMaxBodySize();
-			if (maxBodySize > 0 && parts[i].data.size() > maxBodySize) {
-				result.statusCode = 413;
-				result.statusText = "Payload Too Large";
-				result.errorMessage = "Request body exceeds maximum allowed size";
-				return result;
-			}
-		}
-		
-		// Process each file part
-		for (size_t i = 0; i < parts.size(); ++i) {
-			if (!parts[i].isFile) {
-				continue;  // Skip non-file parts
-			}
-			
-			UploadedFile uploadedFile;
-			uploadedFile.filename = parts[i].filename;
-			uploadedFile.contentType = parts[i].contentType;
-			uploadedFile.size = parts[i].data.size();
-			
-			// Save file
-			std::string savedPath;
-			if (saveFile(uploadDir, parts[i].filename, parts[i].data, savedPath)) {
-				uploadedFile.savedPath = savedPath;
-				result.files.push_back(uploadedFile);
-			}
-			// Continue even if some files fail
-		}
-		
-		if (result.files.empty() && !parts.empty()) {
-			// Had parts but no files were saved
-			bool hadFiles = false;
-			for (size_t i = 0; i < parts.size(); ++i) {
-				if (parts[i].isFile) {
-					hadFiles = true;
-					break;
-				}
-			}
-			
-			if (hadFiles) {
-				result.statusCode = 500;
-				result.statusText = "Internal Server Error";
-				result.errorMessage = "Failed to save uploaded files";
-				return result;
-			}
-			// No file parts - just form data
-		}
+		// Same path as a streamed upload, fed the whole body at once
+		MultipartUpload upload(*this, uploadDir, boundary,
+		                       route.location->getClientMaxBodySize());
+		upload.write(request.getBody().data(), request.getBody().size());
+		return upload.finish();
 	} else {
 		// Check body size
 		size_t maxBodySize = route.location->getClientMaxBodySize();
-		if (maxBodySize > 0 && request.getBody().size() > maxBodySize) {
+		if (maxBodySize > 0 && request.getBodySize() > maxBodySize) {
 			result.statusCode = 413;
 			result.statusText = "Payload Too Large";
 			result.errorMessage = "Request body exceeds maximum allowed size";
@@ -537,7 +435,7 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 		// Handle raw upload (application/octet-stream)
 		// Use filename from Content-Disposition header if present
 		std::string filename = "upload";
-		std::string disposition = request.getHeader("Content-Disposition");
+		const std::string& disposition = request.getHeader(HEADER_CONTENT_DISPOSITION);
 		if (!disposition.empty()) {
 			std::string name;
 			parseContentDisposition(disposition, name, filename);
@@ -545,7 +443,7 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 		
 		if (filename.empty()) {
 			// Try to get filename from X-Filename header
-			filename = request.getHeader("X-Filename");
+			filename = request.getHeader(HEADER_X_FILENAME);
 			if (filename.empty()) {
 				filename = "upload";
 			}
@@ -554,10 +452,23 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 		UploadedFile uploadedFile;
 		uploadedFile.filename = filename;
 		uploadedFile.contentType = getContentType(contentType);
-		uploadedFile.size = request.getBody().size();
+		uploadedFile.size = request.getBodySize();
 		
 		std::string savedPath;
-		if (!saveFile(uploadDir, filename, request.getBody(), savedPath)) {
+		bool saved;
+		if (spool && spool->isFile()) {
+			// Spooled body: the temporary file only needs its name
+			savedPath = uploadDir;
+			if (!savedPath.empty() && savedPath[savedPath.size() - 1] != '/') {
+				savedPath += '/';
+			}
+			savedPath += generateUniqueFilename(uploadDir, filename);
+			saved = spool->linkTo(savedPath);
+		} else {
+			saved = !(spool && spool->hasFailed()) &&
+			        saveFile(uploadDir, filename, spool ? spool->getData() : request.getBody(), savedPath);
+		}
+		if (!saved) {
 			result.statusCode = 500;
 			result.statusText = "Internal Server Error";
 			result.errorMessage = "Failed to save uploaded file";
@@ -576,6 +487,31 @@ UploadResult UploadHandler::handleUpload(const HttpRequest& request,
 	return result;
 }
 
+// Start a streamed multipart upload
+MultipartUpload* UploadHandler::startUpload(const HttpRequest& request,
+                                            const RouteResult& route) {
+	if (!route.matched || !route.location || request.getMethod() != "POST" ||
+	    !isMultipartRequest(request)) {
+		return NULL;
+	}
+	
+	// Without a boundary handleUpload reports the error
+	std::string boundary = extractBoundary(request.getHeader(HEADER_CONTENT_TYPE));
+	if (boundary.empty()) {
+		return NULL;
+	}
+	
+	return new MultipartUpload(*this, getUploadDir(route), boundary,
+	                           route.location->getClientMaxBodySize());
+}
+
+// Spool for a raw upload
+BodySpool* UploadHandler::createSpool(const RouteResult& route, size_t memoryLimit) {
+	std::string uploadDir = getUploadDir(route);
+	ensureDirectory(uploadDir);
+	return new BodySpool(uploadDir, memoryLimit);
+}
+
 // Generate HTML response for upload result
 std::string UploadHandler::generateUploadResponse(const UploadResult& result) const {
 	std::stringstream html;
@@ -623,4 +559,149 @@ std::string UploadHandler::generateUploadResponse(const UploadResult& result) co
 	     << "</html>\n";
 	
 	return html.str();
-}
\ No newline at end of file
+}
+
+// Constructor
+MultipartUpload::MultipartUpload(UploadHandler& handler, const std::string& uploadDir,
+                                 const std::string& boundary, size_t maxPartSize)
+	: _handler(handler),
+	  _uploadDir(uploadDir),
+	  _maxPartSize(maxPartSize),
+	  _parser(boundary, *this),
+	  _part(),
+	  _inPart(false),
+	  _partSize(0),
+	  _partCount(0),
+	  _hadFiles(false),
+	  _fd(-1),
+	  _file(),
+	  _result(),
+	  _failed(false),
+	  _finished(false) {}
+
+// Destructor
+MultipartUpload::~MultipartUpload() {
+	discardPart();
+	if (!_finished || !_result.success) {
+		for (size_t i = 0; i < _result.files.size(); ++i) {
+			unlink(_result.files[i].savedPath.c_str());
+		}
+	}
+}
+
+// Next body bytes
+void MultipartUpload::write(const char* data, size_t size) {
+	if (_failed) {
+		return;
+	}
+	if (!_parser.feed(data, size)) {
+		fail(400, "Bad Request", _parser.getErrorMessage());
+	}
+}
+
+// Whole body received
+UploadResult MultipartUpload::finish() {
+	_finished = true;
+	
+	// A part cut off by the end of the body is not kept
+	discardPart();
+	
+	if (_failed) {
+		return _result;
+	}
+	if (_partCount == 0) {
+		fail(400, "Bad Request", "Failed to parse multipart body");
+		return _result;
+	}
+	if (_result.files.empty() && _hadFiles) {
+		// Had file parts but none were saved
+		fail(500, "Internal Server Error", "Failed to save uploaded files");
+		return _result;
+	}
+	
+	// Success (no file parts - just form data - is fine too)
+	_result.success = true;
+	_result.statusCode = 201;
+	_result.statusText = "Created";
+	return _result;
+}
+
+// A part starts
+void MultipartUpload::onPartBegin(const std::string& headers) {
+	if (_failed || _partCount >= MAX_FILES_PER_UPLOAD) {
+		return;
+	}
+	++_partCount;
+	
+	_part = MultipartPart();
+	_handler.parsePartHeaders(headers, _part);
+	_inPart = true;
+	_partSize = 0;
+	
+	if (_part.isFile) {
+		_hadFiles = true;
+		_file = UploadedFile();
+		_file.filename = _part.filename;
+		_file.contentType = _part.contentType;
+		
+		// A file that cannot be created is skipped; the other parts continue
+		_fd = _handler.createFile(_uploadDir, _part.filename, _file.savedPath);
+	}
+}
+
+// Part content
+void MultipartUpload::onPartData(const char* data, size_t size) {
+	if (_failed || !_inPart) {
+		return;
+	}
+	
+	_partSize += size;
+	if (_maxPartSize > 0 && _partSize > _maxPartSize) {
+		fail(413, "Payload Too Large", "Request body exceeds maximum allowed size");
+		return;
+	}
+	
+	if (_fd >= 0 && !writeAll(_fd, data, size)) {
+		discardPart();
+	}
+}
+
+// Part complete
+void MultipartUpload::onPartEnd() {
+	if (_failed || !_inPart) {
+		return;
+	}
+	_inPart = false;
+	
+	if (_fd >= 0) {
+		int fd = _fd;
+		_fd = -1;
+		if (::close(fd) != 0) {
+			unlink(_file.savedPath.c_str());
+			return;
+		}
+		_file.size = _partSize;
+		_result.files.push_back(_file);
+	}
+}
+
+// Stop saving
+void MultipartUpload::fail(int statusCode, const std::string& statusText,
+                           const std::string& message) {
+	discardPart();
+	_failed = true;
+	_result.success = false;
+	_result.statusCode = statusCode;
+	_result.statusText = statusText;
+	_result.errorMessage = message;
+}
+
+// Drop the current part's file
+void MultipartUpload::discardPart() {
+	_inPart = false;
+	if (_fd >= 0) {
+		::close(_fd);
+		_fd = -1;
+		unlink(_file.savedPath.c_str());
+	}
+}